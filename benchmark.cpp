@@ -0,0 +1,516 @@
+#include "headless_renderer.h"
+#include "mesh.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
+
+namespace {
+	/**
+	 * \brief value as a quoted JSON string, with quotes, backslashes and control characters escaped.
+	 */
+	std::string jsonString(const std::string_view value) {
+		constexpr char hexDigits[] = "0123456789abcdef";
+		std::string result;
+		result.reserve(value.size() + 2);
+		result += '"';
+		for (const char c : value) {
+			if (c == '"' || c == '\\') {
+				result += '\\';
+				result += c;
+			} else if (static_cast<unsigned char>(c) < 0x20) {
+				result += "\\u00";
+				result += hexDigits[static_cast<unsigned char>(c) >> 4];
+				result += hexDigits[static_cast<unsigned char>(c) & 0xf];
+			} else {
+				result += c;
+			}
+		}
+		result += '"';
+		return result;
+	}
+
+	struct BenchmarkResult {
+		std::string name;
+		std::size_t objects{ 0 };
+		std::vector<double> samples; ///< Nanoseconds, one per iteration.
+		std::vector<std::pair<std::string, std::uint64_t>> counters; ///< Written as is next to the timings.
+	};
+
+	/**
+	 * \brief DrawStatistics summed over many frames.
+	 */
+	struct DrawTotals {
+		std::uint64_t draws{ 0 };
+		std::uint64_t pipelineBinds{ 0 };
+		std::uint64_t descriptorSetBinds{ 0 };
+		std::uint64_t skippedPipelineBinds{ 0 };
+		std::uint64_t skippedDescriptorSetBinds{ 0 };
+
+		void add(const DrawStatistics &frame) noexcept {
+			draws += frame.draws;
+			pipelineBinds += frame.pipelineBinds;
+			descriptorSetBinds += frame.descriptorSetBinds;
+			skippedPipelineBinds += frame.skippedPipelineBinds;
+			skippedDescriptorSetBinds += frame.skippedDescriptorSetBinds;
+		}
+
+		[[nodiscard]] std::vector<std::pair<std::string, std::uint64_t>> counters() const {
+			return {{ "draws", draws },
+					{ "pipeline_binds", pipelineBinds },
+					{ "descriptor_set_binds", descriptorSetBinds },
+					{ "skipped_pipeline_binds", skippedPipelineBinds },
+					{ "skipped_descriptor_set_binds", skippedDescriptorSetBinds }};
+		}
+	};
+
+	template<typename Function>
+	BenchmarkResult measure(std::string name, const std::size_t objects, const std::size_t iterations, Function &&function) {
+		BenchmarkResult result{ std::move(name), objects, {}, {}};
+		result.samples.reserve(iterations);
+		for (std::size_t i = 0; i < iterations; ++i) {
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const auto end = std::chrono::steady_clock::now();
+			result.samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+		}
+		std::cerr << result.name << " (" << objects << " objects) : done\n";
+		return result;
+	}
+
+	void writeHostAllocations(std::ostream &out, const HostAllocationStatistics &statistics, const std::uint64_t steadyStateAllocations,
+							  const std::uint64_t steadyStateDeallocations) {
+		out << "{ \"steady_state_heap_allocations\": " << steadyStateAllocations
+			<< ", \"steady_state_heap_deallocations\": " << steadyStateDeallocations << ", \"vulkan\": [";
+		for (std::size_t i = 0; i < HostAllocationStatistics::SCOPE_COUNT; ++i) {
+			out << (i == 0 ? " " : ", ")
+				<< "{ \"scope\": " << jsonString(toString(static_cast<VkSystemAllocationScope>(i)))
+				<< ", \"allocations\": " << statistics.allocations[i]
+				<< ", \"reallocations\": " << statistics.reallocations[i]
+				<< ", \"frees\": " << statistics.frees[i]
+				<< ", \"bytes_in_use\": " << statistics.bytesInUse[i]
+				<< ", \"internal_bytes_in_use\": " << statistics.internalBytesInUse[i]
+				<< " }";
+		}
+		out << " ] }";
+	}
+
+	void writeJson(std::ostream &out, const std::string &deviceName, const MemoryTracker &memory, const HostAllocationStatistics &hostStatistics,
+				   const std::uint64_t steadyStateAllocations, const std::uint64_t steadyStateDeallocations, const std::vector<BenchmarkResult> &results) {
+		out << "{\n\t\"device\": " << jsonString(deviceName) << ",\n\t\"memory\": ";
+		memory.writeStatistics(out);
+		out << ",\n\t\"host_allocations\": ";
+		writeHostAllocations(out, hostStatistics, steadyStateAllocations, steadyStateDeallocations);
+		out << ",\n\t\"benchmarks\": [";
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			auto samples = results[i].samples;
+			std::sort(samples.begin(), samples.end());
+			double sum = 0.;
+			for (const auto sample : samples) {
+				sum += sample;
+			}
+			out << (i == 0 ? "\n" : ",\n")
+				<< "\t\t{ \"name\": " << jsonString(results[i].name)
+				<< ", \"objects\": " << results[i].objects
+				<< ", \"iterations\": " << samples.size()
+				<< ", \"mean_ns\": " << (samples.empty() ? 0. : sum / static_cast<double>(samples.size()))
+				<< ", \"median_ns\": " << (samples.empty() ? 0. : samples[samples.size() / 2])
+				<< ", \"min_ns\": " << (samples.empty() ? 0. : samples.front())
+				<< ", \"max_ns\": " << (samples.empty() ? 0. : samples.back());
+			if (results[i].objects != 0 && !samples.empty()) {
+				out << ", \"objects_per_ms\": " << static_cast<double>(results[i].objects) * 1e6 / samples[samples.size() / 2];
+			}
+			for (const auto &[counter, value] : results[i].counters) {
+				out << ", " << jsonString(counter) << ": " << value;
+			}
+			out << " }";
+		}
+		out << "\n\t]\n}\n";
+	}
+
+	/**
+	 * \brief Fixed scene of objectCount objects, sized like the ones of Simulation.
+	 */
+	SceneState makeScene(const std::size_t objectCount) {
+		Simulation simulation(objectCount);
+		SceneState state{ 0., std::vector<ObjectState>(objectCount) };
+		simulation.sample(state);
+		return state;
+	}
+
+	/**
+	 * \brief Spheres spread around a perspective frustum, a bit less than half of them visible.
+	 */
+	BoundingSpheres makeCullingScene(const std::size_t count) {
+		std::mt19937 generator(42);
+		std::uniform_real_distribution<float> position(-100.f, 100.f);
+		std::uniform_real_distribution<float> depth(-100.f, 0.f);
+		std::uniform_real_distribution<float> radius(0.1f, 2.f);
+		BoundingSpheres spheres(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			spheres.set(i, position(generator), position(generator), depth(generator), radius(generator));
+		}
+		return spheres;
+	}
+
+	/**
+	 * \brief Re-issue every frame of a capture and report their CPU (recording and submission) and GPU times, and the
+	 * draws and binds of all of them.
+	 * \param paced wait for the captured time of each frame instead of replaying as fast as possible.
+	 */
+	void replayCapture(std::ostream &out, const std::string &capturePath, const bool paced) {
+		const CommandStreamReader reader(capturePath);
+		const auto &frames = reader.getFrames();
+		// One target large enough for every pass : each one renders into its own captured extent.
+		std::uint32_t maxDraws = 1;
+		vk::Extent2D extent{ 1, 1 };
+		for (const auto &frame : frames) {
+			maxDraws = std::max(maxDraws, frame.header->drawCount);
+			for (std::uint32_t pass = 0; pass < frame.header->passCount; ++pass) {
+				extent.width = std::max(extent.width, frame.passes[pass].width);
+				extent.height = std::max(extent.height, frame.passes[pass].height);
+			}
+		}
+		HeadlessRenderer renderer(extent, maxDraws);
+
+		std::vector<double> cpuTimes(frames.size());
+		std::vector<std::optional<double>> gpuTimes(frames.size());
+		std::vector<std::uint64_t> submitted(frames.size());
+		constexpr auto framesInFlight = HeadlessRenderer::MAX_FRAMES_IN_FLIGHT;
+		DrawTotals totals;
+		const auto start = std::chrono::steady_clock::now();
+		for (std::size_t f = 0; f < frames.size(); ++f) {
+			if (paced) {
+				std::this_thread::sleep_until(start + std::chrono::nanoseconds(frames[f].header->timestamp - frames.front().header->timestamp));
+			}
+			renderer.beginFrame();
+			// The fence of the frame using this slot before has just been waited on, its timestamps are ready.
+			if (f >= framesInFlight) {
+				gpuTimes[f - framesInFlight] = renderer.getGpuTime(submitted[f - framesInFlight]);
+			}
+			const auto frameStart = std::chrono::steady_clock::now();
+			renderer.replay(frames[f]);
+			submitted[f] = renderer.submit();
+			totals.add(renderer.getDrawStatistics());
+			cpuTimes[f] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - frameStart).count();
+		}
+		renderer.waitIdle();
+		const auto wallTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		for (std::size_t f = frames.size() > framesInFlight ? frames.size() - framesInFlight : 0; f < frames.size(); ++f) {
+			gpuTimes[f] = renderer.getGpuTime(submitted[f]);
+		}
+		std::cerr << "replay of " << frames.size() << " frames : done\n";
+
+		out << "{\n\t\"device\": " << jsonString(renderer.getContext().physicalDevice.getProperties().deviceName.data())
+			<< ",\n\t\"capture\": " << jsonString(capturePath)
+			<< ",\n\t\"paced\": " << (paced ? "true" : "false")
+			<< ",\n\t\"wall_ns\": " << wallTime
+			<< ",\n\t\"draw_statistics\": {";
+		const auto counters = totals.counters();
+		for (std::size_t c = 0; c < counters.size(); ++c) {
+			out << (c == 0 ? " " : ", ") << jsonString(counters[c].first) << ": " << counters[c].second;
+		}
+		out << " },\n\t\"frames\": [";
+		for (std::size_t f = 0; f < frames.size(); ++f) {
+			out << (f == 0 ? "\n" : ",\n")
+				<< "\t\t{ \"index\": " << f
+				<< ", \"passes\": " << frames[f].header->passCount
+				<< ", \"draws\": " << frames[f].header->drawCount
+				<< ", \"cpu_ns\": " << cpuTimes[f]
+				<< ", \"gpu_ns\": ";
+			if (gpuTimes[f]) {
+				out << *gpuTimes[f];
+			} else {
+				out << "null";
+			}
+			out << " }";
+		}
+		out << "\n\t]\n}\n";
+	}
+
+	/**
+	 * \brief Draws spread over 4 passes, 64 pipelines and 256 descriptor sets, at random depths.
+	 */
+	std::vector<DrawPacket> makeDrawPackets(const std::size_t count) {
+		std::mt19937 generator(42);
+		std::uniform_int_distribution<std::uint32_t> pass(0, 3), pipeline(0, 63), descriptorSet(0, 255);
+		std::uniform_real_distribution<float> depth(0.f, 1.f);
+		std::vector<DrawPacket> packets(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			packets[i] = DrawPacket{ DrawKey::make(pass(generator), pipeline(generator), descriptorSet(generator), depth(generator)),
+									 static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(i) };
+		}
+		return packets;
+	}
+
+	/**
+	 * \brief Wavefront OBJ of a wavy grid of size x size quads, with uvs and normals.
+	 */
+	void writeGridObj(const std::string &path, const std::size_t size) {
+		std::ofstream file;
+		file.exceptions(file.exceptions() | std::ofstream::failbit | std::ofstream::badbit);
+		file.open(path, std::ios::trunc);
+		const auto step = 1.f / static_cast<float>(size);
+		for (std::size_t y = 0; y <= size; ++y) {
+			for (std::size_t x = 0; x <= size; ++x) {
+				const auto u = static_cast<float>(x) * step, v = static_cast<float>(y) * step;
+				file << "v " << u << ' ' << v << ' ' << 0.05f * std::sin(20.f * u) * std::cos(20.f * v) << '\n'
+					 << "vt " << u << ' ' << v << '\n'
+					 << "vn 0 0 1\n";
+			}
+		}
+		for (std::size_t y = 0; y < size; ++y) {
+			for (std::size_t x = 0; x < size; ++x) {
+				const auto corner = [size](const std::size_t cx, const std::size_t cy) {
+					const auto index = std::to_string(cy * (size + 1) + cx + 1);
+					return index + '/' + index + '/' + index;
+				};
+				file << "f " << corner(x, y) << ' ' << corner(x + 1, y) << ' ' << corner(x + 1, y + 1) << ' ' << corner(x, y + 1) << '\n';
+			}
+		}
+	}
+
+	/**
+	 * \brief Read every byte of the cache once, so that a load through mmap is timed with its page faults.
+	 */
+	std::uint64_t touchCache(const MeshCache &cache) {
+		std::uint64_t sum = 0;
+		const auto *vertexBytes = cache.vertexData();
+		for (std::size_t i = 0; i < cache.vertexDataSize(); ++i) {
+			sum += static_cast<std::uint8_t>(vertexBytes[i]);
+		}
+		for (std::size_t i = 0; i < cache.indexCount(); ++i) {
+			sum += cache.indices()[i];
+		}
+		return sum;
+	}
+
+	void printUsage(const char *program) {
+		std::cerr << "usage: " << program << " [--output file.json] [--iterations n] [--replay capture [--paced]]\n";
+	}
+
+	/**
+	 * \brief Column major right handed perspective, 90° vertical field of view, depth mapped to [0, 1].
+	 */
+	Frustum cullingFrustum() {
+		constexpr float near = 0.1f, far = 100.f, aspect = 16.f / 9.f;
+		constexpr float projection[16] = { 1.f / aspect, 0.f, 0.f, 0.f,
+										   0.f, -1.f, 0.f, 0.f,
+										   0.f, 0.f, far / (near - far), -1.f,
+										   0.f, 0.f, near * far / (near - far), 0.f };
+		return Frustum::fromMatrix(projection);
+	}
+}
+
+/**
+ * \brief Benchmarks of the renderer hot paths, run headless so that a software ICD is enough :
+ * VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./VulkanTutorialBenchmark --output results.json
+ */
+int main(int argc, char **argv) {
+	std::string outputPath;
+	std::string capturePath;
+	bool paced = false;
+	std::size_t iterations = 100;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			outputPath = argv[++i];
+		} else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			// At least one iteration : the statistics of every benchmark come from its samples.
+			const char *const first = argv[++i];
+			const char *const last = first + std::strlen(first);
+			const auto [end, error] = std::from_chars(first, last, iterations);
+			if (error != std::errc{} || end != last || iterations == 0) {
+				printUsage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		} else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			capturePath = argv[++i];
+		} else if (std::strcmp(argv[i], "--paced") == 0) {
+			paced = true;
+		} else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!capturePath.empty()) {
+		if (outputPath.empty()) {
+			replayCapture(std::cout, capturePath, paced);
+		} else {
+			std::ofstream file(outputPath);
+			replayCapture(file, capturePath, paced);
+		}
+		return EXIT_SUCCESS;
+	}
+
+	constexpr std::size_t workloads[] = { 1, 100, 1'000, 10'000 };
+	constexpr std::size_t maxObjects = 10'000;
+	std::vector<BenchmarkResult> results;
+
+	// Must run while no other device exists : the default dispatcher is re-initialised by each HeadlessDevice.
+	results.push_back(measure("instance_device_creation", 0, std::max<std::size_t>(iterations / 10, 1), [] {
+		const HeadlessDevice context;
+	}));
+
+	{
+		constexpr std::size_t cullingWorkloads[] = { 1'000, 10'000, 100'000, 1'000'000 };
+		const auto frustum = cullingFrustum();
+		std::vector<std::uint32_t> visible;
+		for (const auto objects : cullingWorkloads) {
+			const auto spheres = makeCullingScene(objects);
+			visible.reserve(objects);
+			for (auto kernel = CullingKernel::Scalar; kernel <= bestCullingKernel(); kernel = static_cast<CullingKernel>(static_cast<int>(kernel) + 1)) {
+				// One single thread run, then the same kernel spread over every core.
+				FrustumCuller serial(kernel, std::numeric_limits<std::size_t>::max());
+				results.push_back(measure(std::string("frustum_culling_") + toString(kernel), objects, iterations, [&] {
+					serial.cull(spheres, frustum, visible);
+				}));
+				FrustumCuller parallel(kernel, 0);
+				results.push_back(measure(std::string("frustum_culling_") + toString(kernel) + "_parallel", objects, iterations, [&] {
+					parallel.cull(spheres, frustum, visible);
+				}));
+			}
+		}
+	}
+
+	{
+		constexpr std::size_t sortWorkloads[] = { 1'000, 10'000, 100'000, 1'000'000 };
+		for (const auto packets : sortWorkloads) {
+			const auto unsorted = makeDrawPackets(packets);
+			// Single thread, then one chunk per core.
+			for (const auto threshold : { std::numeric_limits<std::size_t>::max(), std::size_t{ 0 }}) {
+				DrawQueue queue(packets, threshold);
+				std::size_t i = 0;
+				results.push_back(measure(threshold == 0 ? "draw_queue_sort_parallel" : "draw_queue_sort", packets, iterations, [&] {
+					queue.clear();
+					// Rotate the input so that no iteration sorts an already sorted queue.
+					const auto offset = ++i % packets;
+					for (std::size_t p = 0; p < packets; ++p) {
+						queue.push(unsorted[(p + offset) % packets]);
+					}
+					queue.sort();
+				}));
+			}
+		}
+	}
+
+	// Ingestion of a 256 x 256 quads grid, then loading of its caches. Every cache must read back as the imported mesh.
+	bool meshRoundTrip = true;
+	{
+		const auto directory = std::filesystem::temp_directory_path();
+		const auto objPath = (directory / "vulkantutorial_benchmark.obj").string();
+		writeGridObj(objPath, 256);
+		const auto slowIterations = std::max<std::size_t>(iterations / 10, 1);
+		MeshData mesh;
+		results.push_back(measure("mesh_import", 0, slowIterations, [&] {
+			mesh = importMesh(objPath);
+		}));
+		results.back().counters = {{ "vertices", mesh.vertices.size() }, { "triangles", mesh.indices.size() / 3 }};
+		for (const bool quantized : { false, true }) {
+			const auto cachePath = (directory / (quantized ? "vulkantutorial_benchmark_quantized.cache" : "vulkantutorial_benchmark.cache")).string();
+			results.push_back(measure(quantized ? "mesh_cache_write_quantized" : "mesh_cache_write", 0, slowIterations, [&] {
+				writeMeshCache(cachePath, mesh, quantized);
+			}));
+			std::uint64_t checksum = 0;
+			results.push_back(measure(quantized ? "mesh_cache_load_quantized" : "mesh_cache_load", 0, iterations, [&] {
+				const MeshCache cache(cachePath);
+				checksum += touchCache(cache);
+			}));
+			results.back().counters = {{ "bytes", std::filesystem::file_size(cachePath) }};
+			meshRoundTrip = meshRoundTrip && matchesMeshCache(mesh, MeshCache(cachePath)) && checksum != 0;
+			std::filesystem::remove(cachePath);
+		}
+		std::filesystem::remove(objPath);
+	}
+
+	HeadlessRenderer renderer({ 800, 600 }, maxObjects);
+	std::string deviceName;
+	{
+		const HeadlessDevice &context = renderer.getContext();
+		deviceName = context.physicalDevice.getProperties().deviceName.data();
+	}
+
+	{
+		std::size_t i = 0;
+		results.push_back(measure("target_recreation", 0, iterations, [&] {
+			renderer.recreateTarget(++i % 2 ? vk::Extent2D{ 1280, 720 } : vk::Extent2D{ 800, 600 });
+		}));
+	}
+
+	results.push_back(measure("pipeline_creation_no_cache", 0, iterations, [&] {
+		const auto pipeline = renderer.createPipeline();
+	}));
+	{
+		const auto cache = renderer.createPipelineCache();
+		const auto warmup = renderer.createPipeline(*cache);
+		results.push_back(measure("pipeline_creation_cache", 0, iterations, [&] {
+			const auto pipeline = renderer.createPipeline(*cache);
+		}));
+	}
+
+	for (const auto objects : workloads) {
+		const auto scene = makeScene(objects);
+		renderer.waitIdle();
+		DrawTotals totals;
+		results.push_back(measure("command_recording", objects, iterations, [&] {
+			renderer.beginFrame();
+			renderer.record(scene);
+			totals.add(renderer.getDrawStatistics());
+		}));
+		results.back().counters = totals.counters();
+		// The recorded command buffer was never submitted : submit it so the fences stay consistent.
+		renderer.submit();
+		renderer.waitIdle();
+
+		results.push_back(measure("draw_frame", objects, iterations, [&] {
+			renderer.drawFrame(scene);
+		}));
+		renderer.waitIdle();
+	}
+
+	// Once warmed up, a frame must neither reach operator new nor operator delete : the run fails otherwise.
+	std::uint64_t steadyStateAllocations, steadyStateDeallocations;
+	{
+		const auto scene = makeScene(maxObjects);
+		for (std::size_t i = 0; i < 2 * HeadlessRenderer::MAX_FRAMES_IN_FLIGHT; ++i) {
+			renderer.drawFrame(scene);
+		}
+		const auto allocationsBefore = globalAllocationCount();
+		const auto deallocationsBefore = globalDeallocationCount();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			renderer.drawFrame(scene);
+		}
+		steadyStateAllocations = globalAllocationCount() - allocationsBefore;
+		steadyStateDeallocations = globalDeallocationCount() - deallocationsBefore;
+		renderer.waitIdle();
+	}
+
+	const auto hostStatistics = renderer.getContext().hostAllocator.getStatistics();
+	if (outputPath.empty()) {
+		writeJson(std::cout, deviceName, renderer.getMemoryTracker(), hostStatistics, steadyStateAllocations, steadyStateDeallocations, results);
+	} else {
+		std::ofstream file(outputPath);
+		writeJson(file, deviceName, renderer.getMemoryTracker(), hostStatistics, steadyStateAllocations, steadyStateDeallocations, results);
+	}
+	if (!meshRoundTrip) {
+		std::cerr << "A mesh cache does not read back as the imported mesh.\n";
+	}
+	if (steadyStateAllocations != 0 || steadyStateDeallocations != 0) {
+		std::cerr << steadyStateAllocations << " heap allocation(s) and " << steadyStateDeallocations << " deallocation(s) over "
+				  << iterations << " steady-state frames.\n";
+	}
+	return meshRoundTrip && steadyStateAllocations == 0 && steadyStateDeallocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,61 @@
+#include "command_stream.h"
+#include <stdexcept>
+
+static_assert(sizeof(CommandStreamHeader) % 8 == 0 && sizeof(CapturedFrameHeader) % 8 == 0
+			  && sizeof(CapturedPass) % 8 == 0 && sizeof(CapturedDraw) % 8 == 0,
+			  "Capture records must keep the next one aligned.");
+
+CommandStreamWriter::CommandStreamWriter(const std::string &path) : start(std::chrono::steady_clock::now()) {
+	file.open(path, std::ios::binary | std::ios::trunc);
+	const CommandStreamHeader header;
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	if (!file) {
+		throw std::ios_base::failure("Cannot write the capture " + path);
+	}
+}
+
+void CommandStreamWriter::beginFrame(const double time) {
+	this->sceneTime = time;
+	this->timestamp = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	passes.clear();
+	draws.clear();
+}
+
+void CommandStreamWriter::endFrame() {
+	const CapturedFrameHeader header{ timestamp, sceneTime, static_cast<std::uint32_t>(passes.size()), static_cast<std::uint32_t>(draws.size()) };
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(passes.data()), static_cast<std::streamsize>(passes.size() * sizeof(CapturedPass)));
+	file.write(reinterpret_cast<const char *>(draws.data()), static_cast<std::streamsize>(draws.size() * sizeof(CapturedDraw)));
+	if (file) {
+		++frameCount;
+	}
+}
+
+CommandStreamReader::CommandStreamReader(const std::string &path) : file(path) {
+	if (file.size() < sizeof(CommandStreamHeader)) {
+		throw std::runtime_error(path + " is not a command stream capture.");
+	}
+	const auto *header = reinterpret_cast<const CommandStreamHeader *>(file.data());
+	if (header->magic != CommandStreamHeader::MAGIC || header->version != CommandStreamHeader::VERSION) {
+		throw std::runtime_error(path + " is not a command stream capture of version " + std::to_string(CommandStreamHeader::VERSION) + '.');
+	}
+
+	std::size_t offset = sizeof(CommandStreamHeader);
+	while (offset + sizeof(CapturedFrameHeader) <= file.size()) {
+		const auto *frameHeader = reinterpret_cast<const CapturedFrameHeader *>(file.data() + offset);
+		const std::size_t passesOffset = offset + sizeof(CapturedFrameHeader);
+		const std::size_t drawsOffset = passesOffset + frameHeader->passCount * sizeof(CapturedPass);
+		const std::size_t end = drawsOffset + frameHeader->drawCount * sizeof(CapturedDraw);
+		if (end > file.size()) {
+			break;
+		}
+		const auto *passes = reinterpret_cast<const CapturedPass *>(file.data() + passesOffset);
+		for (std::uint32_t pass = 0; pass < frameHeader->passCount; ++pass) {
+			if (passes[pass].width == 0 || passes[pass].height == 0) {
+				throw std::runtime_error(path + " has a pass of frame " + std::to_string(frames.size()) + " with an empty extent.");
+			}
+		}
+		frames.push_back(CapturedFrame{ frameHeader, passes, reinterpret_cast<const CapturedDraw *>(file.data() + drawsOffset) });
+		offset = end;
+	}
+}
@@ -0,0 +1,137 @@
+#ifndef VULKANTUTORIAL_COMMAND_STREAM_H
+#define VULKANTUTORIAL_COMMAND_STREAM_H
+
+#include "mapped_file.h"
+#include "simulation.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Layout of a capture : a CommandStreamHeader, then for each frame a CapturedFrameHeader followed by its passes
+ * and its draws. Every record is a multiple of 8 bytes, so everything stays aligned in the mapping.
+ */
+struct CommandStreamHeader {
+	static constexpr std::uint32_t MAGIC = 0x53435456; // "VTCS"
+	static constexpr std::uint32_t VERSION = 2;
+
+	std::uint32_t magic{ MAGIC };
+	std::uint32_t version{ VERSION };
+};
+
+struct CapturedFrameHeader {
+	std::uint64_t timestamp; ///< Nanoseconds since the start of the capture, taken when the frame was recorded.
+	double sceneTime;
+	std::uint32_t passCount;
+	std::uint32_t drawCount;
+};
+
+/**
+ * \brief Target of one render pass, the objects of that pass are drawn with its aspect ratio.
+ */
+struct CapturedPass {
+	std::uint32_t width;
+	std::uint32_t height;
+};
+
+/**
+ * \brief One draw, in the order it was recorded. The uniforms are rebuilt from object on replay.
+ */
+struct CapturedDraw {
+	std::uint64_t key; ///< DrawKey of the packet.
+	std::uint32_t objectIndex;
+	std::uint32_t reserved{ 0 }; ///< Written as zero, so the file holds no uninitialised padding.
+	ObjectState object;
+};
+
+static_assert(sizeof(CapturedDraw) == 32, "CapturedDraw must not have implicit padding.");
+
+/**
+ * @class CommandStreamWriter
+ * \brief Appends the frames recorded by HelloTriangleApp to a capture, one write per record kind and frame.
+ *
+ * The per frame arrays keep their capacity, so once they have grown to the largest frame capturing does not allocate.
+ * Only the constructor throws : the frames are written from the render loop, failures there are reported by good().
+ */
+class CommandStreamWriter {
+private:
+	std::ofstream file;
+	std::chrono::steady_clock::time_point start;
+	double sceneTime{ 0. };
+	std::uint64_t timestamp{ 0 };
+	std::vector<CapturedPass> passes;
+	std::vector<CapturedDraw> draws;
+	std::uint64_t frameCount{ 0 };
+
+public:
+	/**
+	 * \throw std::ios_base::failure if path cannot be written.
+	 */
+	explicit CommandStreamWriter(const std::string &path);
+
+	void beginFrame(double time);
+
+	void addPass(std::uint32_t width, std::uint32_t height) {
+		passes.push_back(CapturedPass{ width, height });
+	}
+
+	void addDraw(const std::uint64_t key, const std::uint32_t objectIndex, const ObjectState &object) {
+		draws.push_back(CapturedDraw{ key, objectIndex, 0, object });
+	}
+
+	/**
+	 * \brief Write the frame. Does not throw : check good() afterwards.
+	 */
+	void endFrame();
+
+	/**
+	 * \return false once a write failed, e.g. the disk is full. The capture then ends with a cut frame.
+	 */
+	[[nodiscard]] bool good() const noexcept {
+		return file.good();
+	}
+
+	/**
+	 * \brief Frames written completely.
+	 */
+	[[nodiscard]] std::uint64_t getFrameCount() const noexcept {
+		return frameCount;
+	}
+};
+
+/**
+ * \brief View of one frame of a capture, pointing into the mapping of its CommandStreamReader.
+ */
+struct CapturedFrame {
+	const CapturedFrameHeader *header;
+	const CapturedPass *passes;
+	const CapturedDraw *draws;
+};
+
+/**
+ * @class CommandStreamReader
+ * \brief Capture mapped with a single mmap, the frames are indexed once and read in place.
+ *
+ * A frame cut by the end of the file (the capture was not closed properly) is ignored.
+ */
+class CommandStreamReader {
+private:
+	MappedFile file;
+	std::vector<CapturedFrame> frames;
+
+public:
+	/**
+	 * \throw std::runtime_error if path is not a capture of this version, or one of its passes has an empty extent.
+	 */
+	explicit CommandStreamReader(const std::string &path);
+
+	[[nodiscard]] const std::vector<CapturedFrame> &getFrames() const noexcept {
+		return frames;
+	}
+};
+
+#endif //VULKANTUTORIAL_COMMAND_STREAM_H
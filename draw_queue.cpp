@@ -0,0 +1,103 @@
+#include "draw_queue.h"
+#include <algorithm>
+#include <omp.h>
+#include <utility>
+
+DrawQueue::DrawQueue(const std::size_t capacity, const std::size_t parallelThreshold) :
+		histograms(static_cast<std::size_t>(std::max(1, omp_get_max_threads()))), parallelThreshold(parallelThreshold) {
+	reserve(capacity);
+}
+
+void DrawQueue::reserve(const std::size_t capacity) {
+	packets.reserve(capacity);
+	scratch.reserve(capacity);
+}
+
+void DrawQueue::sort() {
+	const std::size_t count = packets.size();
+	if (count < 2) {
+		return;
+	}
+	scratch.resize(count);
+	DrawPacket *source = packets.data();
+	DrawPacket *destination = scratch.data();
+	const std::size_t chunks = count < parallelThreshold ? 1 : histograms.size();
+	const auto chunkBegin = [count, chunks](const std::size_t chunk) {
+		return count * chunk / chunks;
+	};
+
+	for (unsigned shift = 0; shift < 64; shift += RADIX_BITS) {
+#pragma omp parallel for schedule(static) if (chunks > 1)
+		for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+			auto &histogram = histograms[chunk];
+			histogram.fill(0);
+			for (std::size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i) {
+				++histogram[(source[i].key >> shift) & (BUCKETS - 1)];
+			}
+		}
+
+		// A digit shared by every key would only copy the packets around.
+		const auto firstDigit = (source[0].key >> shift) & (BUCKETS - 1);
+		std::size_t sameDigit = 0;
+		for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+			sameDigit += histograms[chunk][firstDigit];
+		}
+		if (sameDigit == count) {
+			continue;
+		}
+
+		// Exclusive prefix sum, bucket major then chunk : each chunk scatters right after the previous one, so the sort stays stable.
+		std::size_t offset = 0;
+		for (std::size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+			for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+				offset += std::exchange(histograms[chunk][bucket], offset);
+			}
+		}
+
+#pragma omp parallel for schedule(static) if (chunks > 1)
+		for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+			auto &histogram = histograms[chunk];
+			for (std::size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i) {
+				destination[histogram[(source[i].key >> shift) & (BUCKETS - 1)]++] = source[i];
+			}
+		}
+		std::swap(source, destination);
+	}
+	if (source != packets.data()) {
+		// Both vectors keep their capacity, no copy back.
+		packets.swap(scratch);
+	}
+}
+
+void DrawRecorder::begin(const vk::CommandBuffer &commandBuffer, const vk::PipelineLayout &pipelineLayout) noexcept {
+	this->commandBuffer = commandBuffer;
+	this->pipelineLayout = pipelineLayout;
+	invalidate();
+	statistics = DrawStatistics{};
+}
+
+void DrawRecorder::bindPipeline(const vk::Pipeline &pipeline) noexcept {
+	if (pipeline == boundPipeline) {
+		++statistics.skippedPipelineBinds;
+		return;
+	}
+	commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+	boundPipeline = pipeline;
+	++statistics.pipelineBinds;
+}
+
+void DrawRecorder::bindDescriptorSet(const vk::DescriptorSet &descriptorSet, const std::uint32_t dynamicOffset) noexcept {
+	if (descriptorSet == boundDescriptorSet && dynamicOffset == boundDynamicOffset) {
+		++statistics.skippedDescriptorSetBinds;
+		return;
+	}
+	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, 1, &descriptorSet, 1, &dynamicOffset);
+	boundDescriptorSet = descriptorSet;
+	boundDynamicOffset = dynamicOffset;
+	++statistics.descriptorSetBinds;
+}
+
+void DrawRecorder::draw(const std::uint32_t vertexCount) noexcept {
+	commandBuffer.draw(vertexCount, 1, 0, 0);
+	++statistics.draws;
+}
@@ -0,0 +1,170 @@
+#ifndef VULKANTUTORIAL_DRAW_QUEUE_H
+#define VULKANTUTORIAL_DRAW_QUEUE_H
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * \brief Packing of the 64 bits sort key of a draw, most significant field first :
+ * pass (4 bits) | pipeline (12 bits) | descriptor set (16 bits) | depth (32 bits).
+ *
+ * Sorting the keys groups the draws by pass, then by pipeline, then by descriptor set, and orders them front to back
+ * within the same state.
+ */
+struct DrawKey {
+	static constexpr unsigned DEPTH_SHIFT = 0;
+	static constexpr unsigned DESCRIPTOR_SET_SHIFT = 32;
+	static constexpr unsigned PIPELINE_SHIFT = 48;
+	static constexpr unsigned PASS_SHIFT = 60;
+	static constexpr std::uint32_t MAX_DESCRIPTOR_SETS = 1u << (PIPELINE_SHIFT - DESCRIPTOR_SET_SHIFT);
+	static constexpr std::uint32_t MAX_PIPELINES = 1u << (PASS_SHIFT - PIPELINE_SHIFT);
+	static constexpr std::uint32_t MAX_PASSES = 1u << (64 - PASS_SHIFT);
+
+	/**
+	 * \brief Bits of depth that sort in the same order as the float, negative values included.
+	 */
+	static std::uint32_t depthBits(const float depth) noexcept {
+		std::uint32_t bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+	}
+
+	static std::uint64_t make(const std::uint32_t pass, const std::uint32_t pipeline, const std::uint32_t descriptorSet, const float depth) noexcept {
+		return static_cast<std::uint64_t>(pass & (MAX_PASSES - 1)) << PASS_SHIFT
+			   | static_cast<std::uint64_t>(pipeline & (MAX_PIPELINES - 1)) << PIPELINE_SHIFT
+			   | static_cast<std::uint64_t>(descriptorSet & (MAX_DESCRIPTOR_SETS - 1)) << DESCRIPTOR_SET_SHIFT
+			   | static_cast<std::uint64_t>(depthBits(depth)) << DEPTH_SHIFT;
+	}
+
+	static std::uint32_t pass(const std::uint64_t key) noexcept {
+		return static_cast<std::uint32_t>(key >> PASS_SHIFT);
+	}
+
+	static std::uint32_t pipeline(const std::uint64_t key) noexcept {
+		return static_cast<std::uint32_t>(key >> PIPELINE_SHIFT) & (MAX_PIPELINES - 1);
+	}
+
+	static std::uint32_t descriptorSet(const std::uint64_t key) noexcept {
+		return static_cast<std::uint32_t>(key >> DESCRIPTOR_SET_SHIFT) & (MAX_DESCRIPTOR_SETS - 1);
+	}
+
+	/**
+	 * \brief key with its pipeline field replaced, the other fields untouched.
+	 */
+	static std::uint64_t withPipeline(const std::uint64_t key, const std::uint32_t pipeline) noexcept {
+		return (key & ~(static_cast<std::uint64_t>(MAX_PIPELINES - 1) << PIPELINE_SHIFT))
+			   | static_cast<std::uint64_t>(pipeline & (MAX_PIPELINES - 1)) << PIPELINE_SHIFT;
+	}
+};
+
+/**
+ * \brief One draw, everything needed to record it once the state of its key is bound.
+ */
+struct DrawPacket {
+	std::uint64_t key;
+	std::uint32_t uniformOffset; ///< Dynamic offset of the ObjectUniforms in the uniform ring.
+	std::uint32_t objectIndex;
+};
+
+/**
+ * @class DrawQueue
+ * \brief Draw packets of one frame, sorted by key with a least significant digit radix sort.
+ *
+ * Both buffers are reserved at construction : pushing up to the capacity and sorting do not allocate. Large queues are
+ * sorted with one histogram and one scatter chunk per OpenMP thread, and the digits shared by every key are skipped.
+ */
+class DrawQueue {
+private:
+	static constexpr unsigned RADIX_BITS = 8;
+	static constexpr std::size_t BUCKETS = 1u << RADIX_BITS;
+
+	std::vector<DrawPacket> packets;
+	std::vector<DrawPacket> scratch;
+	std::vector<std::array<std::size_t, BUCKETS>> histograms; ///< One per chunk.
+	std::size_t parallelThreshold;
+
+public:
+	static constexpr std::size_t DEFAULT_PARALLEL_THRESHOLD = 64 * 1024;
+
+	explicit DrawQueue(std::size_t capacity = 0, std::size_t parallelThreshold = DEFAULT_PARALLEL_THRESHOLD);
+
+	void reserve(std::size_t capacity);
+
+	void clear() noexcept {
+		packets.clear();
+	}
+
+	void push(const DrawPacket &packet) {
+		packets.push_back(packet);
+	}
+
+	/**
+	 * \brief Stable sort of the packets by increasing key.
+	 */
+	void sort();
+
+	[[nodiscard]] const std::vector<DrawPacket> &get() const noexcept {
+		return packets;
+	}
+};
+
+/**
+ * \brief State changes of a frame, as recorded by DrawRecorder.
+ */
+struct DrawStatistics {
+	std::uint32_t draws{ 0 };
+	std::uint32_t pipelineBinds{ 0 };
+	std::uint32_t descriptorSetBinds{ 0 };
+	std::uint32_t skippedPipelineBinds{ 0 }; ///< Requested binds of the pipeline already bound.
+	std::uint32_t skippedDescriptorSetBinds{ 0 };
+};
+
+/**
+ * @class DrawRecorder
+ * \brief Records binds into a command buffer only when they change what is bound, and counts them.
+ */
+class DrawRecorder {
+private:
+	vk::CommandBuffer commandBuffer;
+	vk::PipelineLayout pipelineLayout;
+	vk::Pipeline boundPipeline;
+	vk::DescriptorSet boundDescriptorSet;
+	std::uint32_t boundDynamicOffset{ 0 };
+	DrawStatistics statistics;
+
+public:
+	/**
+	 * \brief Start a new frame : forget what was bound and reset the statistics.
+	 */
+	void begin(const vk::CommandBuffer &commandBuffer, const vk::PipelineLayout &pipelineLayout) noexcept;
+
+	/**
+	 * \brief Forget what was bound, to be called when a new render pass begins.
+	 */
+	void invalidate() noexcept {
+		boundPipeline = vk::Pipeline{};
+		boundDescriptorSet = vk::DescriptorSet{};
+	}
+
+	void bindPipeline(const vk::Pipeline &pipeline) noexcept;
+
+	/**
+	 * \brief Bind set 0 with a single dynamic offset.
+	 */
+	void bindDescriptorSet(const vk::DescriptorSet &descriptorSet, std::uint32_t dynamicOffset) noexcept;
+
+	void draw(std::uint32_t vertexCount) noexcept;
+
+	[[nodiscard]] const DrawStatistics &getStatistics() const noexcept {
+		return statistics;
+	}
+};
+
+#endif //VULKANTUTORIAL_DRAW_QUEUE_H
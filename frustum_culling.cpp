@@ -0,0 +1,200 @@
+#include "frustum_culling.h"
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+	std::size_t cullScalar(const BoundingSpheres &spheres, const Frustum &frustum, const std::size_t begin, const std::size_t end, std::uint32_t *out) noexcept {
+		const float *x = spheres.x();
+		const float *y = spheres.y();
+		const float *z = spheres.z();
+		const float *radius = spheres.radius();
+		std::size_t count = 0;
+		for (std::size_t i = begin; i < end; ++i) {
+			bool inside = true;
+			for (const auto &plane : frustum.planes) {
+				inside &= plane[0] * x[i] + plane[1] * y[i] + plane[2] * z[i] + plane[3] >= -radius[i];
+			}
+			// Branchless compaction : always write, only advance when visible.
+			out[count] = static_cast<std::uint32_t>(i);
+			count += inside;
+		}
+		return count;
+	}
+
+#ifdef __SSE2__
+	std::size_t cullSse(const BoundingSpheres &spheres, const Frustum &frustum, const std::size_t begin, const std::size_t end, std::uint32_t *out) noexcept {
+		__m128 planes[6][4];
+		for (std::size_t p = 0; p < 6; ++p) {
+			for (std::size_t k = 0; k < 4; ++k) {
+				planes[p][k] = _mm_set1_ps(frustum.planes[p][k]);
+			}
+		}
+		const __m128 zero = _mm_setzero_ps();
+		std::size_t count = 0;
+		std::size_t i = begin;
+		for (; i + 4 <= end; i += 4) {
+			const __m128 x = _mm_loadu_ps(spheres.x() + i);
+			const __m128 y = _mm_loadu_ps(spheres.y() + i);
+			const __m128 z = _mm_loadu_ps(spheres.z() + i);
+			const __m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(spheres.radius() + i));
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (const auto &plane : planes) {
+				const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[0], x), _mm_mul_ps(plane[1], y)),
+												   _mm_add_ps(_mm_mul_ps(plane[2], z), plane[3]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+			}
+			for (auto mask = static_cast<unsigned>(_mm_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+				out[count++] = static_cast<std::uint32_t>(i + static_cast<std::size_t>(__builtin_ctz(mask)));
+			}
+		}
+		return count + cullScalar(spheres, frustum, i, end, out + count);
+	}
+#endif
+
+#ifdef __AVX2__
+	std::size_t cullAvx2(const BoundingSpheres &spheres, const Frustum &frustum, const std::size_t begin, const std::size_t end, std::uint32_t *out) noexcept {
+		__m256 planes[6][4];
+		for (std::size_t p = 0; p < 6; ++p) {
+			for (std::size_t k = 0; k < 4; ++k) {
+				planes[p][k] = _mm256_set1_ps(frustum.planes[p][k]);
+			}
+		}
+		const __m256 zero = _mm256_setzero_ps();
+		std::size_t count = 0;
+		std::size_t i = begin;
+		for (; i + 8 <= end; i += 8) {
+			const __m256 x = _mm256_loadu_ps(spheres.x() + i);
+			const __m256 y = _mm256_loadu_ps(spheres.y() + i);
+			const __m256 z = _mm256_loadu_ps(spheres.z() + i);
+			const __m256 negativeRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(spheres.radius() + i));
+			__m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+			for (const auto &plane : planes) {
+#ifdef __FMA__
+				const __m256 distance = _mm256_fmadd_ps(plane[0], x, _mm256_fmadd_ps(plane[1], y, _mm256_fmadd_ps(plane[2], z, plane[3])));
+#else
+				const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane[0], x), _mm256_mul_ps(plane[1], y)),
+													  _mm256_add_ps(_mm256_mul_ps(plane[2], z), plane[3]));
+#endif
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+			}
+			for (auto mask = static_cast<unsigned>(_mm256_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+				out[count++] = static_cast<std::uint32_t>(i + static_cast<std::size_t>(__builtin_ctz(mask)));
+			}
+		}
+		return count + cullScalar(spheres, frustum, i, end, out + count);
+	}
+#endif
+}
+
+Frustum Frustum::fromMatrix(const float (&matrix)[16]) noexcept {
+	// Rows of the column major matrix.
+	const auto row = [&matrix](const std::size_t i) {
+		return std::array<float, 4>{ matrix[i], matrix[4 + i], matrix[8 + i], matrix[12 + i] };
+	};
+	const auto x = row(0), y = row(1), z = row(2), w = row(3);
+	Frustum frustum;
+	for (std::size_t k = 0; k < 4; ++k) {
+		frustum.planes[0][k] = w[k] + x[k];
+		frustum.planes[1][k] = w[k] - x[k];
+		frustum.planes[2][k] = w[k] + y[k];
+		frustum.planes[3][k] = w[k] - y[k];
+		frustum.planes[4][k] = z[k];
+		frustum.planes[5][k] = w[k] - z[k];
+	}
+	// Normalised, so that the distance can be compared to a radius.
+	for (auto &plane : frustum.planes) {
+		const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if (length > 0.f) {
+			for (auto &value : plane) {
+				value /= length;
+			}
+		}
+	}
+	return frustum;
+}
+
+BoundingSpheres::BoundingSpheres(const std::size_t count) {
+	resize(count);
+}
+
+void BoundingSpheres::resize(const std::size_t count) {
+	centerX.resize(count);
+	centerY.resize(count);
+	centerZ.resize(count);
+	radii.resize(count);
+}
+
+const char *toString(const CullingKernel kernel) {
+	switch (kernel) {
+		case CullingKernel::Scalar:
+			return "scalar";
+		case CullingKernel::Sse:
+			return "sse";
+		case CullingKernel::Avx2:
+			return "avx2";
+		default:
+			return "unknown";
+	}
+}
+
+CullingKernel bestCullingKernel() noexcept {
+#if defined(__AVX2__)
+	return CullingKernel::Avx2;
+#elif defined(__SSE2__)
+	return CullingKernel::Sse;
+#else
+	return CullingKernel::Scalar;
+#endif
+}
+
+std::size_t cullRange(const CullingKernel kernel, const BoundingSpheres &spheres, const Frustum &frustum, const std::size_t begin, const std::size_t end, std::uint32_t *out) noexcept {
+	switch (kernel) {
+#ifdef __AVX2__
+		case CullingKernel::Avx2:
+			return cullAvx2(spheres, frustum, begin, end, out);
+#endif
+#ifdef __SSE2__
+		case CullingKernel::Sse:
+			return cullSse(spheres, frustum, begin, end, out);
+#endif
+		default:
+			return cullScalar(spheres, frustum, begin, end, out);
+	}
+}
+
+FrustumCuller::FrustumCuller(const CullingKernel kernel, const std::size_t parallelThreshold) :
+		kernel(kernel), parallelThreshold(parallelThreshold), chunkCounts(static_cast<std::size_t>(std::max(1, omp_get_max_threads()))) {}
+
+std::size_t FrustumCuller::cull(const BoundingSpheres &spheres, const Frustum &frustum, std::vector<std::uint32_t> &visible) {
+	const std::size_t count = spheres.size();
+	visible.resize(count);
+	std::uint32_t *out = visible.data();
+	std::size_t visibleCount;
+	if (count < parallelThreshold || chunkCounts.size() < 2) {
+		visibleCount = cullRange(kernel, spheres, frustum, 0, count, out);
+	} else {
+		const auto chunks = chunkCounts.size();
+		// Chunks start on multiples of 8 : every kernel runs on full registers but the last chunk.
+		const auto chunkBegin = [count, chunks](const std::size_t chunk) {
+			return chunk == chunks ? count : (count * chunk / chunks) & ~std::size_t{ 7 };
+		};
+#pragma omp parallel for schedule(static)
+		for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+			const auto begin = chunkBegin(chunk);
+			chunkCounts[chunk] = cullRange(kernel, spheres, frustum, begin, chunkBegin(chunk + 1), out + begin);
+		}
+		// Each chunk only moves towards the front, a forward copy never overwrites indices not yet moved.
+		visibleCount = chunkCounts[0];
+		for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+			std::copy_n(out + chunkBegin(chunk), chunkCounts[chunk], out + visibleCount);
+			visibleCount += chunkCounts[chunk];
+		}
+	}
+	visible.resize(visibleCount);
+	return visibleCount;
+}
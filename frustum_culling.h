@@ -0,0 +1,122 @@
+#ifndef VULKANTUTORIAL_FRUSTUM_CULLING_H
+#define VULKANTUTORIAL_FRUSTUM_CULLING_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \brief Six normalised planes (a, b, c, d), a point p is inside when a * p.x + b * p.y + c * p.z + d >= 0 for all of them.
+ */
+struct Frustum {
+	std::array<std::array<float, 4>, 6> planes{};
+
+	/**
+	 * \brief Extract the planes of a column major view-projection matrix, with the Vulkan clip volume
+	 * (-w <= x <= w, -w <= y <= w, 0 <= z <= w).
+	 */
+	static Frustum fromMatrix(const float (&matrix)[16]) noexcept;
+};
+
+/**
+ * @class BoundingSpheres
+ * \brief Bounds of the objects stored as a structure of arrays, so that the kernels load 4 or 8 objects per instruction.
+ */
+class BoundingSpheres {
+private:
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radii;
+
+public:
+	BoundingSpheres() = default;
+
+	explicit BoundingSpheres(std::size_t count);
+
+	void resize(std::size_t count);
+
+	[[gnu::always_inline]] inline void set(const std::size_t index, const float x, const float y, const float z, const float radius) noexcept {
+		centerX[index] = x;
+		centerY[index] = y;
+		centerZ[index] = z;
+		radii[index] = radius;
+	}
+
+	[[nodiscard]] std::size_t size() const noexcept {
+		return radii.size();
+	}
+
+	[[nodiscard]] const float *x() const noexcept {
+		return centerX.data();
+	}
+
+	[[nodiscard]] const float *y() const noexcept {
+		return centerY.data();
+	}
+
+	[[nodiscard]] const float *z() const noexcept {
+		return centerZ.data();
+	}
+
+	[[nodiscard]] const float *radius() const noexcept {
+		return radii.data();
+	}
+};
+
+/**
+ * \brief Implementations of the sphere/frustum test. Only the ones enabled by the compiler flags (-march=native) are
+ * built, the others fall back to the scalar one.
+ */
+enum class CullingKernel : std::uint8_t {
+	Scalar,
+	Sse,
+	Avx2
+};
+
+const char *toString(CullingKernel kernel);
+
+/**
+ * \brief Widest kernel available in this build.
+ */
+CullingKernel bestCullingKernel() noexcept;
+
+/**
+ * \brief Test the spheres [begin, end) against frustum and write the indices of the visible ones to out, in order.
+ * \param out must have room for end - begin indices.
+ * \return number of visible spheres written.
+ */
+std::size_t cullRange(CullingKernel kernel, const BoundingSpheres &spheres, const Frustum &frustum, std::size_t begin, std::size_t end, std::uint32_t *out) noexcept;
+
+/**
+ * @class FrustumCuller
+ * \brief Splits the culling of a BoundingSpheres in one chunk per OpenMP thread and compacts the results into a single
+ * list of visible indices, in increasing order.
+ *
+ * Small sets are culled on the calling thread, the fork/join would cost more than the test. Once visible has grown to
+ * the number of spheres, cull() does not allocate anymore.
+ */
+class FrustumCuller {
+private:
+	CullingKernel kernel;
+	std::size_t parallelThreshold;
+	std::vector<std::size_t> chunkCounts; ///< Visible objects per chunk, one chunk per thread.
+
+public:
+	static constexpr std::size_t DEFAULT_PARALLEL_THRESHOLD = 16 * 1024;
+
+	explicit FrustumCuller(CullingKernel kernel = bestCullingKernel(), std::size_t parallelThreshold = DEFAULT_PARALLEL_THRESHOLD);
+
+	/**
+	 * \param visible receives the indices of the visible spheres, its capacity is reused from one call to the other.
+	 * \return number of visible spheres.
+	 */
+	std::size_t cull(const BoundingSpheres &spheres, const Frustum &frustum, std::vector<std::uint32_t> &visible);
+
+	[[nodiscard]] CullingKernel getKernel() const noexcept {
+		return kernel;
+	}
+};
+
+#endif //VULKANTUTORIAL_FRUSTUM_CULLING_H
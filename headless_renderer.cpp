@@ -0,0 +1,236 @@
+#include "headless_renderer.h"
+#include "memory_utils.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+HeadlessDevice::HeadlessDevice() {
+	VULKAN_HPP_DEFAULT_DISPATCHER.init(this->dl.getProcAddress<PFN_vkGetInstanceProcAddr>("vkGetInstanceProcAddr"));
+
+	const vk::ApplicationInfo appInfo{
+			"Vulkan Tutorial headless",
+			VK_MAKE_VERSION(1, 0, 0),
+			"No Engine",
+			VK_MAKE_VERSION(1, 0, 0),
+			VK_API_VERSION_1_1
+	};
+	this->instance = vk::createInstanceUnique(vk::InstanceCreateInfo{{}, &appInfo }, hostAllocator.getCallbacks());
+	VULKAN_HPP_DEFAULT_DISPATCHER.init(*this->instance);
+
+	// No surface to check : any device with a graphics queue will do. The ICD is chosen with VK_ICD_FILENAMES.
+	for (const auto &candidate : this->instance->enumeratePhysicalDevices()) {
+		const auto queueFamilies = candidate.getQueueFamilyProperties();
+		for (std::uint32_t i = 0; i < queueFamilies.size(); ++i) {
+			if (queueFamilies[i].queueCount > 0 && queueFamilies[i].queueFlags & vk::QueueFlagBits::eGraphics) {
+				this->physicalDevice = candidate;
+				this->queueFamily = i;
+				break;
+			}
+		}
+		if (this->physicalDevice) {
+			break;
+		}
+	}
+	if (!this->physicalDevice) {
+		throw std::runtime_error("Failed to find a suitable GPU.");
+	}
+
+	const float queuePriority = 1.0f;
+	const vk::DeviceQueueCreateInfo queueCreateInfo{{}, this->queueFamily, 1, &queuePriority };
+	const vk::PhysicalDeviceFeatures deviceFeatures;
+	std::vector<const char *> extensions;
+	this->memoryBudgetSupported = enableMemoryBudget(this->physicalDevice, extensions);
+	const vk::DeviceCreateInfo createInfo{{}, 1, &queueCreateInfo, 0, nullptr, static_cast<std::uint32_t>(extensions.size()), extensions.data(), &deviceFeatures };
+	this->device = this->physicalDevice.createDeviceUnique(createInfo, hostAllocator.getCallbacks());
+	VULKAN_HPP_DEFAULT_DISPATCHER.init(*this->device);
+	this->queue = this->device->getQueue(this->queueFamily, 0);
+}
+
+HeadlessRenderer::HeadlessRenderer(const vk::Extent2D extent, const std::size_t maxObjects) :
+		memoryTracker(context.physicalDevice, context.memoryBudgetSupported), maxObjects(maxObjects) {
+	this->renderPass = createColorRenderPass(*context.device, colorFormat, vk::ImageLayout::eTransferSrcOptimal);
+	recreateTarget(extent);
+	createDescriptors();
+
+	this->pipelineLayout = createObjectPipelineLayout(*context.device, *descriptorSetLayout);
+	this->vertShaderModule = createShaderModule(*context.device, readFile("shaders/vert.spv"));
+	this->fragShaderModule = createShaderModule(*context.device, readFile("shaders/frag.spv"));
+	this->pipeline = createPipeline();
+
+	createCommandObjects();
+
+	// Sized once : record() only shrinks the lists to the scene and grows them back within their capacity.
+	sceneRecorder.reserve(maxObjects, maxObjects);
+}
+
+void HeadlessRenderer::recreateTarget(const vk::Extent2D newExtent) {
+	context.device->waitIdle();
+	this->framebuffer.reset();
+	this->colorView.reset();
+	this->colorImage.reset();
+	this->colorMemory.reset();
+	this->extent = newExtent;
+
+	const vk::ImageCreateInfo imageInfo{{},
+										vk::ImageType::e2D,
+										colorFormat,
+										vk::Extent3D{ extent.width, extent.height, 1 },
+										1,
+										1,
+										vk::SampleCountFlagBits::e1,
+										vk::ImageTiling::eOptimal,
+										vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc };
+	this->colorImage = context.device->createImageUnique(imageInfo);
+	const auto requirements = context.device->getImageMemoryRequirements(*colorImage);
+	this->colorMemory = memoryTracker.allocate(*context.device, requirements, vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Image);
+	context.device->bindImageMemory(*colorImage, *colorMemory, 0);
+
+	this->colorView = context.device->createImageViewUnique(vk::ImageViewCreateInfo{{},
+																					*colorImage,
+																					vk::ImageViewType::e2D,
+																					colorFormat,
+																					vk::ComponentMapping{},
+																					vk::ImageSubresourceRange{
+																							vk::ImageAspectFlagBits::eColor,
+																							0,
+																							1,
+																							0,
+																							1
+																					}
+	});
+	const vk::FramebufferCreateInfo framebufferInfo{{}, *renderPass, 1, &colorView.get(), extent.width, extent.height, 1 };
+	this->framebuffer = context.device->createFramebufferUnique(framebufferInfo);
+}
+
+void HeadlessRenderer::createDescriptors() {
+	this->descriptorSetLayout = createObjectDescriptorSetLayout(*context.device);
+
+	const auto alignment = context.physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment;
+	const auto bytesPerFrame = UniformRing::alignedSize(sizeof(ObjectUniforms), std::max<vk::DeviceSize>(alignment, 1)) * maxObjects;
+	this->uniformRing = UniformRing(context.physicalDevice, *context.device, memoryTracker, bytesPerFrame, MAX_FRAMES_IN_FLIGHT);
+
+	this->descriptors = createObjectDescriptors(*context.device, *descriptorSetLayout, uniformRing.get());
+}
+
+void HeadlessRenderer::createCommandObjects() {
+	const vk::CommandPoolCreateInfo poolInfo{{ vk::CommandPoolCreateFlagBits::eResetCommandBuffer }, context.queueFamily };
+	this->commandPool = context.device->createCommandPoolUnique(poolInfo);
+	const vk::CommandBufferAllocateInfo allocateInfo{
+			*commandPool,
+			vk::CommandBufferLevel::ePrimary,
+			static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) };
+	this->commandBuffers = context.device->allocateCommandBuffersUnique(allocateInfo);
+
+	constexpr vk::FenceCreateInfo fenceInfo{{ vk::FenceCreateFlagBits::eSignaled }};
+	for (auto &fence : inFlightFences) {
+		fence = context.device->createFenceUnique(fenceInfo);
+	}
+
+	slotFrames.fill(std::numeric_limits<std::uint64_t>::max());
+	const auto validBits = context.physicalDevice.getQueueFamilyProperties()[context.queueFamily].timestampValidBits;
+	if (validBits != 0) {
+		const vk::QueryPoolCreateInfo queryPoolInfo{{}, vk::QueryType::eTimestamp, static_cast<std::uint32_t>(2 * MAX_FRAMES_IN_FLIGHT) };
+		this->timestampPool = context.device->createQueryPoolUnique(queryPoolInfo);
+		this->timestampPeriod = context.physicalDevice.getProperties().limits.timestampPeriod;
+		this->timestampMask = validBits >= 64 ? std::numeric_limits<std::uint64_t>::max() : (std::uint64_t{ 1 } << validBits) - 1;
+	}
+}
+
+vk::UniquePipelineCache HeadlessRenderer::createPipelineCache() const {
+	return context.device->createPipelineCacheUnique(vk::PipelineCacheCreateInfo{});
+}
+
+vk::UniquePipeline HeadlessRenderer::createPipeline(const vk::PipelineCache &cache) const {
+	return createObjectPipeline(*context.device, *pipelineLayout, *renderPass, *vertShaderModule, *fragShaderModule, cache);
+}
+
+void HeadlessRenderer::beginFrame() {
+	if (context.device->waitForFences(1, &inFlightFences[currentFrame].get(), VK_TRUE, std::numeric_limits<std::uint64_t>::max()) != vk::Result::eSuccess) {
+		throw std::runtime_error("Failed to wait for the previous frame.");
+	}
+	uniformRing.beginFrame(currentFrame);
+}
+
+const vk::CommandBuffer &HeadlessRenderer::beginCommandBuffer(const double time) {
+	const auto &commandBuffer = *commandBuffers[currentFrame];
+	{
+		constexpr vk::CommandBufferBeginInfo beginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit };
+		if (commandBuffer.begin(&beginInfo) != vk::Result::eSuccess) {
+			throw std::runtime_error("Failed to begin a command buffer.");
+		}
+	}
+	if (timestampPool) {
+		const auto firstQuery = static_cast<std::uint32_t>(2 * currentFrame);
+		commandBuffer.resetQueryPool(*timestampPool, firstQuery, 2);
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *timestampPool, firstQuery);
+	}
+	sceneRecorder.begin(commandBuffer, *pipelineLayout, descriptors.set, static_cast<float>(time));
+	return commandBuffer;
+}
+
+void HeadlessRenderer::endCommandBuffer(const vk::CommandBuffer &commandBuffer) {
+	if (timestampPool) {
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *timestampPool, static_cast<std::uint32_t>(2 * currentFrame + 1));
+	}
+	if (VULKAN_HPP_DEFAULT_DISPATCHER.vkEndCommandBuffer(static_cast<VkCommandBuffer>(commandBuffer)) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to record a command buffer.");
+	}
+}
+
+void HeadlessRenderer::record(const SceneState &state) {
+	sceneRecorder.clear();
+	static_cast<void>(sceneRecorder.queuePass(0, 0, state, extent, uniformRing));
+	sceneRecorder.sort();
+
+	const auto &commandBuffer = beginCommandBuffer(state.time);
+	sceneRecorder.recordPass(commandBuffer, *renderPass, *framebuffer, extent, 0, &pipeline.get());
+	endCommandBuffer(commandBuffer);
+}
+
+void HeadlessRenderer::replay(const CapturedFrame &frame) {
+	// Captured after sorting : the draws of each pass are contiguous and already in order, no need to sort again.
+	sceneRecorder.clear();
+	const CapturedDraw *draw = frame.draws;
+	const CapturedDraw *const lastDraw = frame.draws + frame.header->drawCount;
+	for (std::uint32_t pass = 0; pass < frame.header->passCount; ++pass) {
+		const float aspect = static_cast<float>(frame.passes[pass].height) / static_cast<float>(frame.passes[pass].width);
+		for (; draw != lastDraw && DrawKey::pass(draw->key) == pass; ++draw) {
+			// A single pipeline here : the captured ones all map to it, which keeps the draws in their captured order.
+			if (!sceneRecorder.queue(DrawKey::withPipeline(draw->key, 0), draw->objectIndex, draw->object, aspect, uniformRing)) {
+				throw std::runtime_error("Uniform ring exhausted while replaying a frame.");
+			}
+		}
+	}
+
+	const auto &commandBuffer = beginCommandBuffer(frame.header->sceneTime);
+	for (std::uint32_t pass = 0; pass < frame.header->passCount; ++pass) {
+		// Each pass draws into the corner of the target matching its captured size, as its swapchain image was.
+		const vk::Extent2D passExtent{ frame.passes[pass].width, frame.passes[pass].height };
+		sceneRecorder.recordPass(commandBuffer, *renderPass, *framebuffer, passExtent, pass, &pipeline.get());
+	}
+	endCommandBuffer(commandBuffer);
+}
+
+std::uint64_t HeadlessRenderer::submit() {
+	const vk::SubmitInfo submitInfo{ 0, nullptr, nullptr, 1, &commandBuffers[currentFrame].get() };
+	if (context.device->resetFences(1, &inFlightFences[currentFrame].get()) != vk::Result::eSuccess
+		|| context.queue.submit(1, &submitInfo, *inFlightFences[currentFrame]) != vk::Result::eSuccess) {
+		throw std::runtime_error("Failed to submit a command buffer.");
+	}
+	slotFrames[currentFrame] = submittedFrames;
+	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	return submittedFrames++;
+}
+
+std::optional<double> HeadlessRenderer::getGpuTime(const std::uint64_t frame) const {
+	const auto slot = static_cast<std::size_t>(frame % MAX_FRAMES_IN_FLIGHT);
+	if (!timestampPool || slotFrames[slot] != frame) {
+		return std::nullopt;
+	}
+	std::array<std::uint64_t, 2> timestamps{};
+	if (context.device->getQueryPoolResults(*timestampPool, static_cast<std::uint32_t>(2 * slot), 2, sizeof(timestamps), timestamps.data(),
+											sizeof(std::uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait) != vk::Result::eSuccess) {
+		return std::nullopt;
+	}
+	return static_cast<double>((timestamps[1] - timestamps[0]) & timestampMask) * timestampPeriod;
+}
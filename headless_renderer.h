@@ -0,0 +1,170 @@
+#ifndef VULKANTUTORIAL_HEADLESS_RENDERER_H
+#define VULKANTUTORIAL_HEADLESS_RENDERER_H
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include <vulkan/vulkan.hpp>
+
+#include "command_stream.h"
+#include "draw_queue.h"
+#include "host_allocator.h"
+#include "memory_tracker.h"
+#include "scene_renderer.h"
+#include "simulation.h"
+#include "uniform_ring.h"
+
+#include <array>
+#include <optional>
+#include <vector>
+
+/**
+ * @class HeadlessDevice
+ * \brief Instance and device without any surface, so it runs on software ICDs (lavapipe, SwiftShader) and CI machines.
+ *
+ * The default dispatcher is global : creating one re-initialises it, so only one HeadlessDevice should be alive at once.
+ */
+class HeadlessDevice {
+public:
+	vk::DynamicLoader dl;
+	HostAllocator hostAllocator; // Must outlive the instance and the device.
+	vk::UniqueInstance instance;
+	vk::PhysicalDevice physicalDevice;
+	vk::UniqueDevice device;
+	std::uint32_t queueFamily{ 0 };
+	vk::Queue queue;
+	bool memoryBudgetSupported{ false }; ///< VK_EXT_memory_budget enabled on device.
+
+	HeadlessDevice();
+};
+
+/**
+ * @class HeadlessRenderer
+ * \brief Same rendering as HelloTriangleApp, through the same SceneRecorder and pipeline, but into an offscreen color
+ * image instead of a swapchain.
+ */
+class HeadlessRenderer {
+public:
+	static constexpr std::size_t MAX_FRAMES_IN_FLIGHT = 2;
+	static constexpr vk::Format colorFormat = vk::Format::eR8G8B8A8Unorm;
+
+private:
+	HeadlessDevice context;
+	MemoryTracker memoryTracker;
+	std::size_t maxObjects;
+	vk::Extent2D extent;
+	vk::UniqueRenderPass renderPass;
+	vk::UniqueImage colorImage;
+	TrackedMemory colorMemory;
+	vk::UniqueImageView colorView;
+	vk::UniqueFramebuffer framebuffer;
+	vk::UniqueDescriptorSetLayout descriptorSetLayout;
+	vk::UniquePipelineLayout pipelineLayout;
+	vk::UniqueShaderModule vertShaderModule;
+	vk::UniqueShaderModule fragShaderModule;
+	vk::UniquePipeline pipeline;
+	UniformRing uniformRing;
+	ObjectDescriptors descriptors;
+	vk::UniqueCommandPool commandPool;
+	std::vector<vk::UniqueCommandBuffer> commandBuffers;
+	std::array<vk::UniqueFence, MAX_FRAMES_IN_FLIGHT> inFlightFences;
+	std::size_t currentFrame{ 0 };
+	vk::UniqueQueryPool timestampPool; ///< Two timestamps per frame in flight, null if the queue cannot write them.
+	double timestampPeriod{ 0. };
+	std::uint64_t timestampMask{ 0 };
+	std::array<std::uint64_t, MAX_FRAMES_IN_FLIGHT> slotFrames; ///< Last frame submitted from each slot.
+	std::uint64_t submittedFrames{ 0 };
+	SceneRecorder sceneRecorder;
+
+	void createDescriptors();
+
+	void createCommandObjects();
+
+	/**
+	 * \brief Begin the command buffer of the current frame with its first timestamp.
+	 */
+	const vk::CommandBuffer &beginCommandBuffer(double time);
+
+	/**
+	 * \brief End the command buffer with the last timestamp.
+	 */
+	void endCommandBuffer(const vk::CommandBuffer &commandBuffer);
+
+public:
+	/**
+	 * \param extent size of the offscreen target.
+	 * \param maxObjects capacity of the uniform ring, per frame, of the culling lists and of the draw queue.
+	 */
+	HeadlessRenderer(vk::Extent2D extent, std::size_t maxObjects);
+
+	/**
+	 * \brief Equivalent of the swapchain recreation : new color image, view and framebuffer.
+	 */
+	void recreateTarget(vk::Extent2D newExtent);
+
+	[[nodiscard]] vk::UniquePipelineCache createPipelineCache() const;
+
+	/**
+	 * \param cache optional, the pipeline is created from scratch without it.
+	 */
+	[[nodiscard]] vk::UniquePipeline createPipeline(const vk::PipelineCache &cache = {}) const;
+
+	/**
+	 * \brief Wait until the command buffer and uniform partition of the current frame are free again.
+	 */
+	void beginFrame();
+
+	/**
+	 * \brief Cull the objects of state, sort their draws and record them into the command buffer of the current frame.
+	 * beginFrame() must have been called.
+	 */
+	void record(const SceneState &state);
+
+	/**
+	 * \brief Re-issue a captured frame as it was recorded : one render pass per captured pass, all into the offscreen
+	 * target, with the uniforms rebuilt from the captured objects. beginFrame() must have been called.
+	 *
+	 * Each pass keeps its captured extent, the target must be at least as large as every pass of frame.
+	 * \throw std::runtime_error if the frame has more draws than the capacity given at construction.
+	 */
+	void replay(const CapturedFrame &frame);
+
+	/**
+	 * \brief Submit the current frame and move on to the next one.
+	 * \return index of the submitted frame, for getGpuTime().
+	 */
+	std::uint64_t submit();
+
+	/**
+	 * \brief GPU time between the first and the last command of frame, in nanoseconds. The frame must be complete : its
+	 * fence waited on by beginFrame() or waitIdle(), and its slot not submitted again since.
+	 * \return nothing if the queue has no timestamps or the slot has been reused.
+	 */
+	[[nodiscard]] std::optional<double> getGpuTime(std::uint64_t frame) const;
+
+	void drawFrame(const SceneState &state) {
+		beginFrame();
+		record(state);
+		submit();
+	}
+
+	[[nodiscard]] const HeadlessDevice &getContext() const noexcept {
+		return context;
+	}
+
+	/**
+	 * \brief Draws and state changes of the last recorded frame.
+	 */
+	[[nodiscard]] const DrawStatistics &getDrawStatistics() const noexcept {
+		return sceneRecorder.getStatistics();
+	}
+
+	[[nodiscard]] MemoryTracker &getMemoryTracker() noexcept {
+		return memoryTracker;
+	}
+
+	void waitIdle() const {
+		context.device->waitIdle();
+	}
+};
+
+#endif //VULKANTUTORIAL_HEADLESS_RENDERER_H
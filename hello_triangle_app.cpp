@@ -1,4 +1,5 @@
 #include "hello_triangle_app.h"
+#include "memory_utils.h"
 #include <iostream>
 #include <cstring>
 #include <utility>
@@ -16,6 +17,7 @@ void HelloTriangleApp::run() {
 	VULKAN_HPP_DEFAULT_DISPATCHER.init(vkGetInstanceProcAddr);
 	initWindow();
 	initVulkan();
+	simulation.start();
 	mainLoop();
 	cleanup();
 }
@@ -84,7 +86,7 @@ void HelloTriangleApp::createInstance() {
 		createInfo.pNext = nullptr;
 	}
 
-	this->instance = vk::createInstanceUnique(createInfo);
+	this->instance = vk::createInstanceUnique(createInfo, hostAllocator.getCallbacks());
 	VULKAN_HPP_DEFAULT_DISPATCHER.init(*this->instance);
 	//C++ bindings have exceptions enabled by defaults so no need to check the value anymore.
 }
@@ -126,15 +128,22 @@ std::vector<const char *> HelloTriangleApp::getRequiredExtensions() {
 void HelloTriangleApp::initVulkan() {
 	createInstance();
 	setupDebugCallback();
-	createSurface();
+	createSurfaces();
 	pickPhysicalDevice();
 	createLogicalDevice();
-	createSwapChain();
-	createImageViews();
-	createRenderPass();
-	createGraphicsPipeline();
-	createFramebuffers();
+	createMemoryTracker();
+	createDescriptorSetLayout();
+	createPipelineLayout();
+	for (auto &target : surfaces) {
+		createSwapChain(target);
+		createImageViews(target);
+		createRenderPass(target);
+		createGraphicsPipeline(target);
+		createFramebuffers(target);
+	}
 	createCommandPool();
+	createUniformRing();
+	createDescriptorSets();
 	createCommandBuffers();
 	createSyncObjects();
 }
@@ -169,71 +178,138 @@ void HelloTriangleApp::setupDebugCallback() {
 }
 
 void HelloTriangleApp::mainLoop() {
-	while (!glfwWindowShouldClose(this->window)) {
+	std::size_t steadyFrames = 0;
+	// Closing any of the windows ends the application.
+	while (std::none_of(surfaces.cbegin(), surfaces.cend(), [](const WindowSurface &target) { return glfwWindowShouldClose(target.window); })) {
 		glfwPollEvents();
+		const auto allocations = globalAllocationCount();
+		const auto deallocations = globalDeallocationCount();
+		const auto recreations = swapChainRecreations;
 		drawFrame();
+		// Once warmed up, a frame must neither reach operator new nor operator delete : everything it needs was reserved
+		// beforehand, and nothing allocated before is released behind its back. Validation layers allocate behind our back,
+		// only release builds are checked.
+		if (recreations != swapChainRecreations) {
+			steadyFrames = 0;
+		} else if (!enableValidationLayers && ++steadyFrames > STEADY_STATE_WARMUP
+				   && (globalAllocationCount() != allocations || globalDeallocationCount() != deallocations)) {
+			++allocatingFrames;
+		}
 	}
 }
 
-void HelloTriangleApp::drawFrame() {
-	this->device->waitForFences(*inFlightFences[currentFrame], true, std::numeric_limits<std::uint32_t>::max());
-	this->device->resetFences(*inFlightFences[currentFrame]);
-	const auto result = this->device->acquireNextImageKHR(*swapChain,
-														  std::numeric_limits<std::uint32_t>::max(),
-														  *imageAvailableSemaphores[currentFrame],
-														  vk::Fence{});
-	if (result.result == vk::Result::eErrorOutOfDateKHR) {
-		recreateSwapChain();
-		return;
-	} else if (result.result != vk::Result::eSuccess && result.result != vk::Result::eSuboptimalKHR) {
+bool HelloTriangleApp::acquireNextImage(WindowSurface &target) {
+	if (target.minimized && !recreateSwapChain(target)) {
+		return false;
+	}
+	const auto result = this->device->acquireNextImageKHR(*target.swapChain,
+														  std::numeric_limits<std::uint64_t>::max(),
+														  *target.imageAvailableSemaphores[currentFrame],
+														  vk::Fence{},
+														  &target.imageIndex);
+	if (result == vk::Result::eErrorOutOfDateKHR) {
+		recreateSwapChain(target);
+		return false;
+	} else if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR) {
 		throw std::runtime_error("échec de la présentation d'une image à la swap chain!");
 	}
 
-	const std::uint32_t imageIndex = result.value;
-	if (imagesInFlight[imageIndex]) {
-		device->waitForFences(imagesInFlight[imageIndex], true, std::numeric_limits<std::uint32_t>::max());
+	if (target.imagesInFlight[target.imageIndex]) {
+		if (device->waitForFences(1, &target.imagesInFlight[target.imageIndex], VK_TRUE, std::numeric_limits<std::uint64_t>::max()) != vk::Result::eSuccess) {
+			throw std::runtime_error("échec de l'attente d'une image de la swap chain!");
+		}
 	}
-	imagesInFlight[imageIndex] = *inFlightFences[currentFrame];
+	target.imagesInFlight[target.imageIndex] = *inFlightFences[currentFrame];
+	return true;
+}
+
+void HelloTriangleApp::drawFrame() {
+	// Only the non throwing overloads are used from here on : the steady-state frame neither allocates nor throws,
+	// an exception is left for failures the application cannot recover from.
+	if (this->device->waitForFences(1, &inFlightFences[currentFrame].get(), VK_TRUE, std::numeric_limits<std::uint64_t>::max()) != vk::Result::eSuccess) {
+		throw std::runtime_error("échec de l'attente de la frame précédente!");
+	}
+	// The simulation keeps ticking on its own thread while the GPU works : only pick its latest state here.
+	simulation.sample(sceneState);
+	if (++frameCount % MEMORY_POLL_INTERVAL == 0) {
+		memoryTracker.poll();
+	}
+
+	frameWaitSemaphores.clear();
+	frameWaitStages.clear();
+	frameSwapChains.clear();
+	frameImageIndices.clear();
+	framePresentSurfaces.clear();
+	for (auto &target : surfaces) {
+		if (acquireNextImage(target)) {
+			frameWaitSemaphores.push_back(*target.imageAvailableSemaphores[currentFrame]);
+			frameWaitStages.emplace_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+			frameSwapChains.push_back(*target.swapChain);
+			frameImageIndices.push_back(target.imageIndex);
+			framePresentSurfaces.push_back(&target);
+		}
+	}
+	if (framePresentSurfaces.empty()) {
+		// Nothing submitted, so the fence of this frame stays signaled for the next try.
+		if (std::all_of(surfaces.cbegin(), surfaces.cend(), [](const WindowSurface &target) { return target.minimized; })) {
+			glfwWaitEvents();
+		}
+		return;
+	}
+
+	recordCommandBuffer(*commandBuffers[currentFrame]);
 
 	{
-		const vk::PipelineStageFlags waitStages{ vk::PipelineStageFlagBits::eColorAttachmentOutput };
 		const vk::SubmitInfo submitInfo{
+				static_cast<std::uint32_t>(frameWaitSemaphores.size()),
+				frameWaitSemaphores.data(),
+				frameWaitStages.data(),
 				1,
-				&imageAvailableSemaphores[currentFrame].get(),
-				&waitStages,
-				1,
-				&commandBuffers[imageIndex].get(),
+				&commandBuffers[currentFrame].get(),
 				1,
 				&renderFinishedSemaphores[currentFrame].get() };
 
-		device->resetFences(*inFlightFences[currentFrame]);
-
-		graphicsQueue.submit(submitInfo, *inFlightFences[currentFrame]);
+		if (device->resetFences(1, &inFlightFences[currentFrame].get()) != vk::Result::eSuccess
+			|| graphicsQueue.submit(1, &submitInfo, *inFlightFences[currentFrame]) != vk::Result::eSuccess) {
+			throw std::runtime_error("échec de la soumission du command buffer!");
+		}
 	}
 
-	try {
-		const vk::PresentInfoKHR presentInfo{ 1, &renderFinishedSemaphores[currentFrame].get(), 1, &swapChain.get(), &imageIndex };
-		const auto resultQueue = presentQueue.presentKHR(presentInfo);
-		if (resultQueue == vk::Result::eSuboptimalKHR || framebufferResized) {
-			framebufferResized = false;
-			recreateSwapChain();
-		} else if (resultQueue != vk::Result::eSuccess) {
-			throw std::runtime_error("échec de la présentation d'une image!");
+	{
+		// One present for all the swapchains, each one reporting its own result.
+		framePresentResults.resize(frameSwapChains.size());
+		const vk::PresentInfoKHR presentInfo{
+				1,
+				&renderFinishedSemaphores[currentFrame].get(),
+				static_cast<std::uint32_t>(frameSwapChains.size()),
+				frameSwapChains.data(),
+				frameImageIndices.data(),
+				framePresentResults.data() };
+		static_cast<void>(presentQueue.presentKHR(&presentInfo));
+		for (std::size_t i = 0; i < framePresentResults.size(); ++i) {
+			auto &target = *framePresentSurfaces[i];
+			const auto resultQueue = framePresentResults[i];
+			if (resultQueue == vk::Result::eErrorOutOfDateKHR || resultQueue == vk::Result::eSuboptimalKHR || target.framebufferResized) {
+				target.framebufferResized = false;
+				recreateSwapChain(target);
+			} else if (resultQueue != vk::Result::eSuccess) {
+				throw std::runtime_error("échec de la présentation d'une image!");
+			}
 		}
-	} catch (const vk::OutOfDateKHRError &error) {
-		framebufferResized = false;
-		recreateSwapChain();
-	} catch (const std::exception &exception) {
-		std::cerr << "exception not handled\n";
-		__throw_exception_again;
 	}
 
 	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
 void HelloTriangleApp::cleanup() {
+	simulation.stop();
 	device->waitIdle();
-	glfwDestroyWindow(this->window);
+	if (allocatingFrames != 0) {
+		std::cerr << allocatingFrames << " steady-state frame(s) allocated or freed on the heap.\n";
+	}
+	for (auto &target : surfaces) {
+		glfwDestroyWindow(target.window);
+	}
 
 	glfwTerminate();
 }
@@ -244,16 +320,28 @@ void HelloTriangleApp::initWindow() {
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API); //Tell glfw to NOT create OpenGL context.
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
-	window = glfwCreateWindow(this->largeur, this->hauteur, this->windowName.c_str(), nullptr, nullptr);
-	glfwSetWindowUserPointer(window, this);
-	glfwSetFramebufferSizeCallback(window, [](GLFWwindow *wwindow, [[maybe_unused]] int width, [[maybe_unused]] int height) {
-		auto *__restrict app = reinterpret_cast<HelloTriangleApp *>(glfwGetWindowUserPointer(wwindow));
-		app->framebufferResized = true;
-	});
+	surfaces.resize(windowCount);
+	surfacePipelines.resize(windowCount);
+	for (std::size_t i = 0; i < surfaces.size(); ++i) {
+		auto &target = surfaces[i];
+		target.largeur = this->largeur;
+		target.hauteur = this->hauteur;
+		const auto title = surfaces.size() == 1 ? this->windowName : this->windowName + ' ' + std::to_string(i + 1);
+		target.window = glfwCreateWindow(target.largeur, target.hauteur, title.c_str(), nullptr, nullptr);
+		glfwSetWindowUserPointer(target.window, &target);
+		glfwSetFramebufferSizeCallback(target.window, [](GLFWwindow *wwindow, [[maybe_unused]] int width, [[maybe_unused]] int height) {
+			auto *__restrict resized = reinterpret_cast<WindowSurface *>(glfwGetWindowUserPointer(wwindow));
+			resized->framebufferResized = true;
+		});
+	}
 }
 
-HelloTriangleApp::HelloTriangleApp(std::string windowName, const uint32_t l, const uint32_t h) :
-		windowName(std::move(windowName)), largeur(l), hauteur(h) {}
+HelloTriangleApp::HelloTriangleApp(std::string windowName, const uint32_t l, const uint32_t h, const std::size_t windowCount) :
+		windowName(std::move(windowName)), largeur(l), hauteur(h), windowCount(std::clamp<std::size_t>(windowCount, 1, DrawKey::MAX_PASSES)) {}
+
+void HelloTriangleApp::startCapture(const std::string &path) {
+	this->capture.emplace(path);
+}
 
 VKAPI_ATTR vk::Bool32 VKAPI_CALL HelloTriangleApp::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
 																 [[maybe_unused]] VkDebugUtilsMessageTypeFlagsEXT messageType,
@@ -272,8 +360,10 @@ bool HelloTriangleApp::isDeviceSuitable(const vk::PhysicalDevice &device) {
 	bool swapChainAdequate = false;
 
 	if (extensionsSupported) {
-		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
-		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+		swapChainAdequate = std::all_of(surfaces.cbegin(), surfaces.cend(), [&device](const WindowSurface &target) {
+			const SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device, *target.surface);
+			return !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+		});
 	}
 
 	return indices.isComplete() && extensionsSupported && swapChainAdequate;
@@ -300,8 +390,11 @@ QueueFamilyIndices HelloTriangleApp::findQueueFamilies(const vk::PhysicalDevice
 			indices.graphicsFamily = i;
 		}
 
-		vk::Bool32 presentSupport = false;
-		presentSupport = device.getSurfaceSupportKHR(i, *this->surface);
+		// The single present of each frame goes through one queue : it has to support every surface.
+		vk::Bool32 presentSupport = true;
+		for (const auto &target : this->surfaces) {
+			presentSupport = presentSupport && device.getSurfaceSupportKHR(i, *target.surface);
+		}
 
 		if (queueFamily.queueCount > 0 && presentSupport) {
 			indices.presentFamily = i;
@@ -344,13 +437,14 @@ void HelloTriangleApp::createLogicalDevice() {
 	for (const auto &extension_name : this->deviceExtensions) {
 		extensions.push_back(extension_name.c_str());
 	}
+	this->memoryBudgetSupported = enableMemoryBudget(this->physicalDevice, extensions);
 
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(this->deviceExtensions.size());
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
 	createInfo.ppEnabledExtensionNames = extensions.data();
 
 	if (enableValidationLayers) {
@@ -364,26 +458,38 @@ void HelloTriangleApp::createLogicalDevice() {
 		createInfo.enabledLayerCount = 0;
 	}
 
-	this->device = this->physicalDevice.createDeviceUnique(createInfo);
+	this->device = this->physicalDevice.createDeviceUnique(createInfo, hostAllocator.getCallbacks());
 	VULKAN_HPP_DEFAULT_DISPATCHER.init(*this->device);
 
 	this->graphicsQueue = this->device->getQueue(indices.graphicsFamily.value(), 0);
 	this->presentQueue = this->device->getQueue(indices.presentFamily.value(), 0);
 }
 
-void HelloTriangleApp::createSurface() {
-	VkSurfaceKHR psurf = nullptr;
-	if (glfwCreateWindowSurface(*this->instance, this->window, nullptr, &psurf) != VK_SUCCESS) {
-		throw std::runtime_error("Failed to create window surface !");
+void HelloTriangleApp::createMemoryTracker() {
+	this->memoryTracker = MemoryTracker(this->physicalDevice, this->memoryBudgetSupported);
+	// Logging is the only response : every device allocation of the application (swapchains, uniform ring) is required,
+	// there is nothing optional to shed. It at least makes the over-subscription visible before the driver starts paging,
+	// once per crossing of the threshold.
+	this->memoryTracker.addPressureCallback([](const std::uint32_t heapIndex, const HeapStatistics &statistics) {
+		std::cerr << "memory heap " << heapIndex << " close to its budget : " << statistics.usage << " / " << statistics.budget << " bytes\n";
+	});
+}
+
+void HelloTriangleApp::createSurfaces() {
+	for (auto &target : surfaces) {
+		VkSurfaceKHR psurf = nullptr;
+		if (glfwCreateWindowSurface(*this->instance, target.window, nullptr, &psurf) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create window surface !");
+		}
+		target.surface = vk::UniqueSurfaceKHR(psurf, *this->instance);
 	}
-	this->surface = vk::UniqueSurfaceKHR(psurf, *this->instance);
 }
 
-SwapChainSupportDetails HelloTriangleApp::querySwapChainSupport(const vk::PhysicalDevice &device) {
+SwapChainSupportDetails HelloTriangleApp::querySwapChainSupport(const vk::PhysicalDevice &device, const vk::SurfaceKHR &surface) {
 	SwapChainSupportDetails details;
-	device.getSurfaceCapabilitiesKHR(*this->surface, &details.capabilities);
-	details.formats = device.getSurfaceFormatsKHR(*this->surface);
-	details.presentModes = device.getSurfacePresentModesKHR(*this->surface);
+	device.getSurfaceCapabilitiesKHR(surface, &details.capabilities);
+	details.formats = device.getSurfaceFormatsKHR(surface);
+	details.presentModes = device.getSurfacePresentModesKHR(surface);
 	return details;
 }
 
@@ -405,33 +511,33 @@ vk::PresentModeKHR HelloTriangleApp::chooseSwapPresentMode(const std::vector<vk:
 	return vk::PresentModeKHR::eFifoRelaxed;
 }
 
-vk::Extent2D HelloTriangleApp::chooseSwapExtent(const vk::SurfaceCapabilitiesKHR &capabilities) {
+vk::Extent2D HelloTriangleApp::chooseSwapExtent(WindowSurface &target, const vk::SurfaceCapabilitiesKHR &capabilities) {
 	if (capabilities.currentExtent.width != std::numeric_limits<std::uint32_t>::max()) {
 		return capabilities.currentExtent;
 	} else {
-		glfwGetFramebufferSize(window, reinterpret_cast<int *>(&largeur), reinterpret_cast<int *>(&hauteur));
-		vk::Extent2D actualExtent{ largeur, hauteur };
+		glfwGetFramebufferSize(target.window, reinterpret_cast<int *>(&target.largeur), reinterpret_cast<int *>(&target.hauteur));
+		vk::Extent2D actualExtent{ target.largeur, target.hauteur };
 		actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
 		actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
 		return actualExtent;
 	}
 }
 
-void HelloTriangleApp::createSwapChain() {
-	const auto swapChainSupport = querySwapChainSupport(this->physicalDevice);
+void HelloTriangleApp::createSwapChain(WindowSurface &target) {
+	const auto swapChainSupport = querySwapChainSupport(this->physicalDevice, *target.surface);
 	const auto surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
 	const auto presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
-	const auto extent = chooseSwapExtent(swapChainSupport.capabilities);
+	const auto extent = chooseSwapExtent(target, swapChainSupport.capabilities);
 
 	std::uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-	this->tmpVal.emplace_back(extent);
-	this->tmpVal.emplace_back(surfaceFormat.format);
+	target.extent = extent;
+	target.format = surfaceFormat.format;
 
 	if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
 		imageCount = swapChainSupport.capabilities.maxImageCount;
 	}
 	vk::SwapchainCreateInfoKHR createInfo{{},
-										  *this->surface,
+										  *target.surface,
 										  imageCount,
 										  surfaceFormat.format,
 										  surfaceFormat.colorSpace,
@@ -454,243 +560,200 @@ void HelloTriangleApp::createSwapChain() {
 	createInfo.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
 	createInfo.presentMode = presentMode;
 	createInfo.clipped = true;
-	oldSwpChain = !this->swapChain ? nullptr : this->swapChain.release();
-	createInfo.oldSwapchain = oldSwpChain;
-	this->swapChain = this->device->createSwapchainKHRUnique(createInfo);
-	this->swapChainImages = this->device->getSwapchainImagesKHR(*this->swapChain);
+	target.oldSwpChain = !target.swapChain ? nullptr : target.swapChain.release();
+	createInfo.oldSwapchain = target.oldSwpChain;
+	target.swapChain = this->device->createSwapchainKHRUnique(createInfo);
+	target.swapChainImages = this->device->getSwapchainImagesKHR(*target.swapChain);
+
+	// The driver allocates the images. With VK_EXT_memory_budget its heap usage already counts them : poll it now rather
+	// than adding an estimate on top. Without it, record an estimate, 4 bytes per pixel for the formats chosen above.
+	if (memoryBudgetSupported) {
+		memoryTracker.poll();
+		return;
+	}
+	const auto heapIndex = memoryTracker.deviceLocalHeap();
+	memoryTracker.release(heapIndex, MemoryCategory::Swapchain, target.swapChainBytes);
+	target.swapChainBytes = vk::DeviceSize{ 4 } * extent.width * extent.height * target.swapChainImages.size();
+	memoryTracker.record(heapIndex, MemoryCategory::Swapchain, target.swapChainBytes);
 }
 
-void HelloTriangleApp::createImageViews() {
-	swapChainImageViews.resize(swapChainImages.size());
-	{
-		const auto swapChainSupport = querySwapChainSupport(this->physicalDevice);
-		const auto format = chooseSwapSurfaceFormat(swapChainSupport.formats).format;
-		for (size_t i = 0; i < swapChainImages.size(); ++i) {
-			swapChainImageViews[i] =
-					this->device->createImageViewUnique(vk::ImageViewCreateInfo{{},
-																				swapChainImages[i],
-																				vk::ImageViewType::e2D,
-																				format,
-																				vk::ComponentMapping{},
-																				vk::ImageSubresourceRange{
-																						vk::ImageAspectFlagBits::eColor,
-																						0,
-																						1,
-																						0,
-																						1
-																				}
-					});
-		}
+void HelloTriangleApp::createImageViews(WindowSurface &target) {
+	target.swapChainImageViews.resize(target.swapChainImages.size());
+	for (size_t i = 0; i < target.swapChainImages.size(); ++i) {
+		target.swapChainImageViews[i] =
+				this->device->createImageViewUnique(vk::ImageViewCreateInfo{{},
+																			target.swapChainImages[i],
+																			vk::ImageViewType::e2D,
+																			target.format,
+																			vk::ComponentMapping{},
+																			vk::ImageSubresourceRange{
+																					vk::ImageAspectFlagBits::eColor,
+																					0,
+																					1,
+																					0,
+																					1
+																			}
+				});
 	}
 }
 
-static std::vector<char> readFile(const std::string &filename) {
-	std::ifstream file;
-	file.exceptions(file.exceptions() | std::ifstream::failbit | std::ifstream::badbit);
-	file.open(filename, std::ios::ate | std::ios::binary);
-	std::size_t fileSize = file.tellg();
-	std::vector<char> buffer(fileSize);
-
-	file.seekg(0);
-	file.read(buffer.data(), fileSize);
-	return buffer;
+void HelloTriangleApp::createGraphicsPipeline(WindowSurface &target) {
+	const auto vertShaderModule = createShaderModule(*this->device, readFile("shaders/vert.spv"));
+	const auto fragShaderModule = createShaderModule(*this->device, readFile("shaders/frag.spv"));
+	target.pipeline = createObjectPipeline(*this->device, *pipelineLayout, *target.renderPass, *vertShaderModule, *fragShaderModule);
+	surfacePipelines[static_cast<std::size_t>(&target - surfaces.data())] = *target.pipeline;
 }
 
-void HelloTriangleApp::createGraphicsPipeline() {
-	const auto vertShaderCode = readFile("shaders/vert.spv");
-	const auto fragShaderCode = readFile("shaders/frag.spv");
-
-	const auto vertShaderModule = createShaderModule(vertShaderCode);
-	const auto fragShaderModule = createShaderModule(fragShaderCode);
+void HelloTriangleApp::createRenderPass(WindowSurface &target) {
+	target.renderPass = createColorRenderPass(*this->device, target.format, vk::ImageLayout::ePresentSrcKHR);
+}
 
-	const vk::PipelineShaderStageCreateInfo shaderStages[] = {
-			vk::PipelineShaderStageCreateInfo{
-					{},
-					vk::ShaderStageFlagBits::eVertex,
-					*vertShaderModule,
-					"main" },
-			vk::PipelineShaderStageCreateInfo{
-					{},
-					vk::ShaderStageFlagBits::eFragment,
-					*fragShaderModule,
-					"main" }
-	};
-	const vk::PipelineVertexInputStateCreateInfo vertexInputInfo{{}, 0, nullptr, 0, nullptr };
-	const vk::PipelineInputAssemblyStateCreateInfo inputAssembly{{}, vk::PrimitiveTopology::eTriangleList, false };
-	const vk::Viewport viewport{
-			0.0f,
-			0.0f,
-			static_cast<float>(std::any_cast<vk::Extent2D>(tmpVal[0]).width),
-			static_cast<float>(std::any_cast<vk::Extent2D>(tmpVal[0]).height),
-			0.0f,
-			0.1f };
-	const vk::Rect2D scissor{{ 0, 0 }, std::any_cast<vk::Extent2D>(tmpVal[0]) };
-
-	const vk::PipelineViewportStateCreateInfo viewportState{{},
-															1,
-															&viewport,
-															1,
-															&scissor };
-	const vk::PipelineRasterizationStateCreateInfo rasterizer{{},
-															  false,
-															  false,
-															  vk::PolygonMode::eFill,
-															  vk::CullModeFlagBits::eBack,
-															  vk::FrontFace::eClockwise,
-															  false,
-															  0.0f,
-															  0.0f,
-															  0.0f,
-															  1.0f };
-	const vk::PipelineMultisampleStateCreateInfo multisampling{{},
-															   vk::SampleCountFlagBits::e1,
-															   false,
-															   1.0f,
-															   nullptr,
-															   false,
-															   false };
-	const vk::PipelineColorBlendAttachmentState colorBlendAttachment{
-			false,
-			vk::BlendFactor::eOne,
-			vk::BlendFactor::eZero,
-			vk::BlendOp::eAdd,
-			vk::BlendFactor::eOne,
-			vk::BlendFactor::eZero,
-			vk::BlendOp::eAdd,
-			vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA };
-	const vk::PipelineColorBlendStateCreateInfo colorBlending{{}, false, vk::LogicOp::eCopy, 1, &colorBlendAttachment, { 0.0f, 0.0f, 0.0f, 0.0f }};
-	const vk::DynamicState dynamicStates[] = { vk::DynamicState::eViewport, vk::DynamicState::eLineWidth };
-	const vk::PipelineDynamicStateCreateInfo dynamicState{{}, 2, dynamicStates };
-	const vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, 0, nullptr, 0, nullptr };
-	this->pipelineLayout = this->device->createPipelineLayoutUnique(pipelineLayoutInfo);
-
-	const vk::GraphicsPipelineCreateInfo pipelineInfo{
-			{}, 2, shaderStages, &vertexInputInfo, &inputAssembly, nullptr, &viewportState, &rasterizer, &multisampling,
-			nullptr, &colorBlending,
-			nullptr, *pipelineLayout, *renderPass, 0 };
-	this->pipeline = this->device->createGraphicsPipelineUnique({}, pipelineInfo).value;
-}
-
-vk::UniqueShaderModule HelloTriangleApp::createShaderModule(const std::vector<char> &code) {
-	return this->device->createShaderModuleUnique(vk::ShaderModuleCreateInfo{
-			{},
-			code.size(),
-			reinterpret_cast<const std::uint32_t *>(code.data())
-	});
+void HelloTriangleApp::createFramebuffers(WindowSurface &target) {
+	target.swapChainFramebuffers.resize(target.swapChainImageViews.size());
+	for (size_t i = 0; i < target.swapChainImageViews.size(); ++i) {
+		const vk::FramebufferCreateInfo framebufferInfo{{}, *target.renderPass, 1, &target.swapChainImageViews[i].get(), target.extent.width, target.extent.height, 1 };
+		target.swapChainFramebuffers[i] = this->device->createFramebufferUnique(framebufferInfo);
+	}
 }
 
-void HelloTriangleApp::createRenderPass() {
-	const vk::AttachmentDescription colorAttachment{{},
-													std::any_cast<vk::Format>(tmpVal[1]),
-													vk::SampleCountFlagBits::e1,
-													vk::AttachmentLoadOp::eClear,
-													vk::AttachmentStoreOp::eStore,
-													vk::AttachmentLoadOp::eDontCare,
-													vk::AttachmentStoreOp::eDontCare,
-													vk::ImageLayout::eUndefined,
-													vk::ImageLayout::ePresentSrcKHR };
-	constexpr vk::AttachmentReference colorAttachmentRef{ 0, vk::ImageLayout::eColorAttachmentOptimal };
-	const vk::SubpassDescription subpass{{}, vk::PipelineBindPoint::eGraphics, {}, {}, 1, &colorAttachmentRef };
-	constexpr vk::SubpassDependency dependency{
-			VK_SUBPASS_EXTERNAL,
-			0,
-			{ vk::PipelineStageFlagBits::eColorAttachmentOutput },
-			{ vk::PipelineStageFlagBits::eColorAttachmentOutput },
-			{ vk::AccessFlagBits::eMemoryRead },
-			{ vk::AccessFlagBits::eColorAttachmentWrite }
-	};
-	const vk::RenderPassCreateInfo renderPassInfo{{}, 1, &colorAttachment, 1, &subpass, 1, &dependency };
-	this->renderPass = this->device->createRenderPassUnique(renderPassInfo);
+void HelloTriangleApp::createDescriptorSetLayout() {
+	this->descriptorSetLayout = createObjectDescriptorSetLayout(*this->device);
 }
 
-void HelloTriangleApp::createFramebuffers() {
-	swapChainFramebuffers.resize(swapChainImageViews.size());
-	const auto extent = std::any_cast<vk::Extent2D>(tmpVal[0]);
-	for (size_t i = 0; i < swapChainImageViews.size(); ++i) {
-		const vk::FramebufferCreateInfo framebufferInfo{{}, *renderPass, 1, &swapChainImageViews[i].get(), extent.width, extent.height, 1 };
-		swapChainFramebuffers[i] = this->device->createFramebufferUnique(framebufferInfo);
-	}
+void HelloTriangleApp::createPipelineLayout() {
+	this->pipelineLayout = createObjectPipelineLayout(*this->device, *descriptorSetLayout);
 }
 
 void HelloTriangleApp::createCommandPool() {
 	const auto queueFamilyIndices = findQueueFamilies(this->physicalDevice);
-	const vk::CommandPoolCreateInfo poolInfo{{}, queueFamilyIndices.graphicsFamily.value() };
+	const vk::CommandPoolCreateInfo poolInfo{{ vk::CommandPoolCreateFlagBits::eResetCommandBuffer }, queueFamilyIndices.graphicsFamily.value() };
 	this->commandPool = this->device->createCommandPoolUnique(poolInfo);
 }
 
+void HelloTriangleApp::createUniformRing() {
+	const auto alignment = this->physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment;
+	// Every surface draws all the objects, with its own aspect ratio.
+	const auto bytesPerFrame = UniformRing::alignedSize(sizeof(ObjectUniforms), std::max<vk::DeviceSize>(alignment, 1)) * objectCount * surfaces.size();
+	this->uniformRing = UniformRing(this->physicalDevice, *this->device, this->memoryTracker, bytesPerFrame, MAX_FRAMES_IN_FLIGHT);
+}
+
+void HelloTriangleApp::createDescriptorSets() {
+	this->descriptors = createObjectDescriptors(*this->device, *descriptorSetLayout, uniformRing.get());
+}
+
 void HelloTriangleApp::createCommandBuffers() {
-	commandBuffers.resize(swapChainFramebuffers.size());
 	const vk::CommandBufferAllocateInfo allocateInfo{
 			*commandPool,
 			vk::CommandBufferLevel::ePrimary,
-			static_cast<uint32_t>(commandBuffers.size()) };
+			static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) };
 	this->commandBuffers = this->device->allocateCommandBuffersUnique(allocateInfo);
-	for (size_t i = 0; i < commandBuffers.size(); ++i) {
-		{
-			const vk::CommandBufferBeginInfo beginInfo;
-			commandBuffers[i]->begin(beginInfo);
+}
+
+void HelloTriangleApp::recordCommandBuffer(const vk::CommandBuffer &commandBuffer) {
+	uniformRing.beginFrame(currentFrame);
+	// The draws of every surface go through one queue, the pass of a draw being the index of its surface.
+	sceneRecorder.clear();
+	for (std::uint32_t pass = 0; pass < framePresentSurfaces.size(); ++pass) {
+		// Each surface has its own pipeline, found in surfacePipelines. The ring is sized for every surface to draw every object.
+		const auto pipeline = static_cast<std::uint32_t>(framePresentSurfaces[pass] - surfaces.data());
+		static_cast<void>(sceneRecorder.queuePass(pass, pipeline, sceneState, framePresentSurfaces[pass]->extent, uniformRing));
+	}
+	sceneRecorder.sort();
+	if (capture) {
+		capture->beginFrame(sceneState.time);
+		for (const auto *target : framePresentSurfaces) {
+			capture->addPass(target->extent.width, target->extent.height);
+		}
+		for (const auto &packet : sceneRecorder.getDraws()) {
+			capture->addDraw(packet.key, packet.objectIndex, sceneState.objects[packet.objectIndex]);
 		}
-		{
-			const vk::ClearValue clearColor{ std::array{ 0.f, 0.f, 0.f, 1.f }};
-			const vk::RenderPassBeginInfo renderPassInfo{
-					*renderPass, *swapChainFramebuffers[i],
-					{{ 0, 0 }, std::any_cast<vk::Extent2D>(tmpVal[0]) },
-					1, &clearColor };
-			commandBuffers[i]->beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+		capture->endFrame();
+		if (!capture->good()) {
+			// Losing the capture must not end the application : stop capturing and keep drawing.
+			std::cerr << "Capture stopped after " << capture->getFrameCount() << " frame(s) : writing failed.\n";
+			capture.reset();
+		}
+	}
+
+	{
+		constexpr vk::CommandBufferBeginInfo beginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit };
+		if (commandBuffer.begin(&beginInfo) != vk::Result::eSuccess) {
+			throw std::runtime_error("échec du début de l'enregistrement d'un command buffer!");
 		}
-		commandBuffers[i]->bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
-		commandBuffers[i]->draw(3, 1, 0, 0);
-		commandBuffers[i]->endRenderPass();
-		commandBuffers[i]->end();
+	}
+	sceneRecorder.begin(commandBuffer, *pipelineLayout, descriptors.set, static_cast<float>(sceneState.time));
+	// One render pass per acquired surface, all in the same command buffer : a single submit feeds every swapchain.
+	for (std::uint32_t pass = 0; pass < framePresentSurfaces.size(); ++pass) {
+		const auto *target = framePresentSurfaces[pass];
+		sceneRecorder.recordPass(commandBuffer, *target->renderPass, *target->swapChainFramebuffers[target->imageIndex], target->extent, pass,
+								 surfacePipelines.data());
+	}
+	// The enhanced end() throws, the C entry point only reports.
+	if (VULKAN_HPP_DEFAULT_DISPATCHER.vkEndCommandBuffer(static_cast<VkCommandBuffer>(commandBuffer)) != VK_SUCCESS) {
+		throw std::runtime_error("échec de l'enregistrement d'un command buffer!");
 	}
 }
 
 void HelloTriangleApp::createSyncObjects() {
 	constexpr vk::FenceCreateInfo fenceInfo{{ vk::FenceCreateFlagBits::eSignaled }};
-	imagesInFlight.resize(swapChainImages.size());
 	for (std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-		this->imageAvailableSemaphores[i] = this->device->createSemaphoreUnique({});
 		this->renderFinishedSemaphores[i] = this->device->createSemaphoreUnique({});
 		this->inFlightFences[i] = this->device->createFenceUnique(fenceInfo);
 	}
+	for (auto &target : surfaces) {
+		target.imagesInFlight.resize(target.swapChainImages.size());
+		for (auto &semaphore : target.imageAvailableSemaphores) {
+			semaphore = this->device->createSemaphoreUnique({});
+		}
+	}
+
+	frameWaitSemaphores.reserve(surfaces.size());
+	frameWaitStages.reserve(surfaces.size());
+	frameSwapChains.reserve(surfaces.size());
+	frameImageIndices.reserve(surfaces.size());
+	framePresentResults.reserve(surfaces.size());
+	framePresentSurfaces.reserve(surfaces.size());
+	sceneRecorder.reserve(objectCount, objectCount * surfaces.size());
 }
 
-void HelloTriangleApp::recreateSwapChain() {
-	glfwGetFramebufferSize(window, reinterpret_cast<int *>(&largeur), reinterpret_cast<int *>(&hauteur));
-	while (largeur == 0 || hauteur == 0) {
-		glfwGetFramebufferSize(window, reinterpret_cast<int *>(&largeur), reinterpret_cast<int *>(&hauteur));
-		glfwWaitEvents();
+bool HelloTriangleApp::recreateSwapChain(WindowSurface &target) {
+	int width = 0, height = 0;
+	glfwGetFramebufferSize(target.window, &width, &height);
+	if (width == 0 || height == 0) {
+		// Do not wait here : the other windows keep being drawn meanwhile.
+		target.minimized = true;
+		return false;
 	}
+	target.minimized = false;
+	target.largeur = static_cast<uint32_t>(width);
+	target.hauteur = static_cast<uint32_t>(height);
 
 	this->device->waitIdle();
+	++swapChainRecreations;
 
-	cleanupSwapChain();
+	cleanupSwapChain(target);
 
-	createSwapChain();
-	createImageViews();
-	createRenderPass();
-	createGraphicsPipeline();
-	createFramebuffers();
-	createCommandBuffers();
+	createSwapChain(target);
+	createImageViews(target);
+	createRenderPass(target);
+	createGraphicsPipeline(target);
+	createFramebuffers(target);
+	target.imagesInFlight.assign(target.swapChainImages.size(), vk::Fence{});
+	return true;
 }
 
-void HelloTriangleApp::cleanupSwapChain() {
-	for (auto &framebuffer : swapChainFramebuffers) {
+void HelloTriangleApp::cleanupSwapChain(WindowSurface &target) {
+	for (auto &framebuffer : target.swapChainFramebuffers) {
 //		device->destroyFramebuffer(framebuffer.release());
 		framebuffer.reset(); // Équivalent du dessus
 	}
 
-	for (auto &command_buffer : commandBuffers) {
-		command_buffer.reset();
-	}
-
-	pipeline.reset();
-	pipelineLayout.reset();
-	renderPass.reset();
+	target.pipeline.reset();
+	target.renderPass.reset();
 
-	for (auto &image_view : swapChainImageViews) {
+	for (auto &image_view : target.swapChainImageViews) {
 		image_view.reset();
 	}
 
-	this->device->destroy(oldSwpChain, {});
-}
\ No newline at end of file
+	this->device->destroy(target.oldSwpChain, {});
+}
@@ -12,9 +12,15 @@
 #include <vulkan/vulkan.hpp>
 #include <GLFW/glfw3.h>
 
+#include "command_stream.h"
+#include "draw_queue.h"
+#include "host_allocator.h"
+#include "scene_renderer.h"
+#include "simulation.h"
+#include "uniform_ring.h"
+
 #include <string>
 #include <optional>
-#include <any>
 
 struct QueueFamilyIndices {
 	std::optional<uint32_t> graphicsFamily;
@@ -31,49 +37,96 @@ struct SwapChainSupportDetails {
 	std::vector<vk::PresentModeKHR> presentModes;
 };
 
-
 /**
  * @class HelloTriangleApp
  */
 class HelloTriangleApp {
 private:
 	static constexpr std::size_t MAX_FRAMES_IN_FLIGHT = 2;
+	/// Heap usage and budget are refreshed every that many frames.
+	static constexpr std::size_t MEMORY_POLL_INTERVAL = 120;
+	/**
+	 * Frames after start-up or a swapchain recreation before a frame is expected to be allocation free. By then every
+	 * swapchain image has been acquired and presented many times (drivers and the WSI allocate on the first uses of an
+	 * image) and the capture arrays have grown to the largest frame. About 3 s at 60 Hz : a margin, not a measured bound.
+	 */
+	static constexpr std::size_t STEADY_STATE_WARMUP = 180;
+
+	/**
+	 * \brief Everything tied to one window : surface, swapchain and what depends on its images, format or extent.
+	 */
+	struct WindowSurface {
+		GLFWwindow *window{ nullptr };
+		vk::UniqueSurfaceKHR surface;
+		vk::UniqueSwapchainKHR swapChain;
+		vk::SwapchainKHR oldSwpChain;
+		vk::Format format{ vk::Format::eUndefined };
+		vk::Extent2D extent;
+		std::vector<vk::Image> swapChainImages;
+		std::vector<vk::UniqueImageView> swapChainImageViews;
+		vk::UniqueRenderPass renderPass;
+		vk::UniquePipeline pipeline;
+		std::vector<vk::UniqueFramebuffer> swapChainFramebuffers;
+		std::array<vk::UniqueSemaphore, MAX_FRAMES_IN_FLIGHT> imageAvailableSemaphores;
+		std::vector<vk::Fence> imagesInFlight;
+		vk::DeviceSize swapChainBytes{ 0 }; ///< Estimate recorded in the MemoryTracker, without VK_EXT_memory_budget only.
+		std::uint32_t imageIndex{ 0 };
+		uint32_t largeur = 800;
+		uint32_t hauteur = 600;
+		bool framebufferResized{ false };
+		bool minimized{ false };
+	};
+
 	// Members
-	GLFWwindow *window{ nullptr };
 	vk::DynamicLoader dl;
+	HostAllocator hostAllocator; // Must outlive the instance and the device.
 	vk::UniqueInstance instance;
 	vk::UniqueDebugUtilsMessengerEXT callback;
-	vk::UniqueSurfaceKHR surface;
 	vk::PhysicalDevice physicalDevice;
 	vk::UniqueDevice device;
 	vk::Queue graphicsQueue;
 	vk::Queue presentQueue;
-	vk::UniqueSwapchainKHR swapChain;
-	vk::SwapchainKHR oldSwpChain;
-	std::vector<vk::Image> swapChainImages;
-	std::vector<vk::UniqueImageView> swapChainImageViews;
-	vk::UniqueRenderPass renderPass;
+	bool memoryBudgetSupported{ false };
+	MemoryTracker memoryTracker;
+	std::size_t frameCount{ 0 };
+	std::size_t swapChainRecreations{ 0 };
+	std::size_t allocatingFrames{ 0 }; ///< Steady-state frames that still reached operator new or delete, see mainLoop().
+	/// Created once in initWindow() and never resized : GLFW keeps pointers to its elements.
+	std::vector<WindowSurface> surfaces;
+	/// Pipeline of each surface, indexed like surfaces and by the pipeline field of the draw keys.
+	std::vector<vk::Pipeline> surfacePipelines;
+	vk::UniqueDescriptorSetLayout descriptorSetLayout;
 	vk::UniquePipelineLayout pipelineLayout;
-	vk::UniquePipeline pipeline;
-	std::vector<vk::UniqueFramebuffer> swapChainFramebuffers;
 	vk::UniqueCommandPool commandPool;
-	std::vector<vk::UniqueCommandBuffer> commandBuffers;
-	std::array<vk::UniqueSemaphore, MAX_FRAMES_IN_FLIGHT> imageAvailableSemaphores;
+	std::vector<vk::UniqueCommandBuffer> commandBuffers; // One per frame in flight, recorded each frame for all surfaces.
+	UniformRing uniformRing;
+	ObjectDescriptors descriptors;
 	std::array<vk::UniqueSemaphore, MAX_FRAMES_IN_FLIGHT> renderFinishedSemaphores;
 	std::array<vk::UniqueFence, MAX_FRAMES_IN_FLIGHT> inFlightFences;
-	std::vector<vk::Fence> imagesInFlight;
 	std::size_t currentFrame{ 0 };
-	bool framebufferResized{ false };
+	// Scratch arrays of the single submit / present, sized once for all the surfaces.
+	std::vector<vk::Semaphore> frameWaitSemaphores;
+	std::vector<vk::PipelineStageFlags> frameWaitStages;
+	std::vector<vk::SwapchainKHR> frameSwapChains;
+	std::vector<std::uint32_t> frameImageIndices;
+	std::vector<vk::Result> framePresentResults;
+	std::vector<WindowSurface *> framePresentSurfaces;
+
+	const std::size_t objectCount{ 1024 };
+	Simulation simulation{ objectCount };
+	/// Interpolated state used by the frame being recorded, written in place by Simulation::sample.
+	SceneState sceneState{ 0., std::vector<ObjectState>(objectCount) };
+	SceneRecorder sceneRecorder; ///< Reserved for objectCount draws per surface in createSyncObjects().
+	std::optional<CommandStreamWriter> capture; ///< Set by startCapture(), fed by recordCommandBuffer().
 
 	std::vector<std::string> validationLayers{ "VK_LAYER_KHRONOS_validation" };
 	std::vector<std::string> deviceExtensions{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
-	std::vector<std::any> tmpVal;
-
 	const std::string windowName = "Hello";
 	static const char *const appName;
 	uint32_t largeur = 800;
 	uint32_t hauteur = 600;
+	std::size_t windowCount{ 1 };
 
 #ifdef NDEBUG
 	static constexpr bool enableValidationLayers = false;
@@ -106,37 +159,53 @@ private:
 
 	void createLogicalDevice();
 
-	void createSurface();
+	void createMemoryTracker();
+
+	void createSurfaces();
 
-	void createSwapChain();
+	void createSwapChain(WindowSurface &target);
 
-	SwapChainSupportDetails querySwapChainSupport(const vk::PhysicalDevice &device);
+	static SwapChainSupportDetails querySwapChainSupport(const vk::PhysicalDevice &device, const vk::SurfaceKHR &surface);
 
 	static vk::SurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<vk::SurfaceFormatKHR> &availableFormats);
 
 	static vk::PresentModeKHR chooseSwapPresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes);
 
-	[[nodiscard]] vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR &capabilities);
+	[[nodiscard]] static vk::Extent2D chooseSwapExtent(WindowSurface &target, const vk::SurfaceCapabilitiesKHR &capabilities);
 
-	void createImageViews();
+	void createImageViews(WindowSurface &target);
 
-	void createGraphicsPipeline();
+	void createDescriptorSetLayout();
 
-	vk::UniqueShaderModule createShaderModule(const std::vector<char> &code);
+	void createPipelineLayout();
 
-	void createRenderPass();
+	void createGraphicsPipeline(WindowSurface &target);
 
-	void createFramebuffers();
+	void createRenderPass(WindowSurface &target);
+
+	void createFramebuffers(WindowSurface &target);
 
 	void createCommandPool();
 
+	void createUniformRing();
+
+	void createDescriptorSets();
+
 	void createCommandBuffers();
 
+	void recordCommandBuffer(const vk::CommandBuffer &commandBuffer);
+
 	void createSyncObjects();
 
-	void recreateSwapChain();
+	/**
+	 * \brief Recreate the swapchain of one surface, leaving the others untouched.
+	 * \return false if the window is minimized : the surface is then skipped until it has a size again.
+	 */
+	bool recreateSwapChain(WindowSurface &target);
+
+	void cleanupSwapChain(WindowSurface &target);
 
-	void cleanupSwapChain();
+	bool acquireNextImage(WindowSurface &target);
 
 	void mainLoop();
 
@@ -153,7 +222,14 @@ private:
 public:
 	HelloTriangleApp() = default;
 
-	HelloTriangleApp(std::string windowName, const uint32_t l, const uint32_t h);
+	/**
+	 * \param windowName
+	 * \param l width of each window.
+	 * \param h height of each window.
+	 * \param windowCount number of windows, all drawn by the same device with one submit and one present per frame.
+	 * At most DrawKey::MAX_PASSES, one render pass each.
+	 */
+	HelloTriangleApp(std::string windowName, const uint32_t l, const uint32_t h, const std::size_t windowCount = 1);
 
 	/**
 	 * \brief To add a validation layer before the run method.
@@ -164,8 +240,29 @@ public:
 
 	virtual ~HelloTriangleApp() = default;
 
+	/**
+	 * \brief Per heap usage and budget, e.g. to register pressure callbacks or export the statistics.
+	 */
+	[[nodiscard]] MemoryTracker &getMemoryTracker() noexcept {
+		return memoryTracker;
+	}
+
+	/**
+	 * \brief Record every frame drawn from now on into a capture, to be replayed by VulkanTutorialBenchmark --replay.
+	 * \throw std::ios_base::failure if path cannot be written.
+	 */
+	void startCapture(const std::string &path);
+
 	void run();
 
+	/**
+	 * \brief Frames of the last run() that reached operator new or delete once warmed up. Always 0 with the validation
+	 * layers, which allocate behind our back.
+	 */
+	[[nodiscard]] std::size_t getAllocatingFrames() const noexcept {
+		return allocatingFrames;
+	}
+
 };
 
 
@@ -0,0 +1,300 @@
+#include "host_allocator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+	std::atomic<std::uint64_t> globalAllocations{ 0 };
+	std::atomic<std::uint64_t> globalDeallocations{ 0 };
+
+	void *countedAllocate(std::size_t size, std::size_t alignment) noexcept {
+		globalAllocations.fetch_add(1, std::memory_order_relaxed);
+		size = std::max<std::size_t>(size, 1);
+		if (alignment <= alignof(std::max_align_t)) {
+			return std::malloc(size);
+		}
+		// aligned_alloc wants a size multiple of the alignment.
+		return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+	}
+
+	void *throwingAllocate(const std::size_t size, const std::size_t alignment) {
+		while (true) {
+			if (void *memory = countedAllocate(size, alignment)) {
+				return memory;
+			}
+			const auto handler = std::get_new_handler();
+			if (!handler) {
+				throw std::bad_alloc();
+			}
+			handler();
+		}
+	}
+
+	void countedFree(void *memory) noexcept {
+		if (memory) {
+			globalDeallocations.fetch_add(1, std::memory_order_relaxed);
+			std::free(memory);
+		}
+	}
+
+	/**
+	 * \brief Stored right before every pointer given to the driver.
+	 */
+	struct ChunkHeader {
+		void *chunk;
+		std::size_t size;
+		std::uint32_t sizeClass;
+		std::uint32_t scope;
+	};
+
+	constexpr std::uint32_t LARGE_CLASS = ~0u;
+
+	std::size_t scopeIndex(const VkSystemAllocationScope scope) noexcept {
+		return std::min<std::size_t>(static_cast<std::size_t>(scope), HostAllocationStatistics::SCOPE_COUNT - 1);
+	}
+}
+
+std::uint64_t globalAllocationCount() noexcept {
+	return globalAllocations.load(std::memory_order_relaxed);
+}
+
+std::uint64_t globalDeallocationCount() noexcept {
+	return globalDeallocations.load(std::memory_order_relaxed);
+}
+
+void *operator new(const std::size_t size) {
+	return throwingAllocate(size, 0);
+}
+
+void *operator new[](const std::size_t size) {
+	return throwingAllocate(size, 0);
+}
+
+void *operator new(const std::size_t size, const std::align_val_t alignment) {
+	return throwingAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](const std::size_t size, const std::align_val_t alignment) {
+	return throwingAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept {
+	return countedAllocate(size, 0);
+}
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept {
+	return countedAllocate(size, 0);
+}
+
+void *operator new(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](const std::size_t size, const std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *memory) noexcept {
+	countedFree(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+	countedFree(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+	countedFree(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+	countedFree(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+	countedFree(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+	countedFree(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+	countedFree(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {
+	countedFree(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+	countedFree(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+	countedFree(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+	countedFree(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+	countedFree(memory);
+}
+
+const char *toString(const VkSystemAllocationScope scope) {
+	switch (scope) {
+		case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+			return "command";
+		case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+			return "object";
+		case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+			return "cache";
+		case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+			return "device";
+		case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+			return "instance";
+		default:
+			return "unknown";
+	}
+}
+
+HostAllocator::HostAllocator() :
+		callbacks(this, &HostAllocator::allocationCallback, &HostAllocator::reallocationCallback, &HostAllocator::freeCallback,
+				  &HostAllocator::internalAllocationCallback, &HostAllocator::internalFreeCallback) {}
+
+HostAllocator::~HostAllocator() {
+	while (blocks) {
+		void *next;
+		std::memcpy(&next, static_cast<std::byte *>(blocks) + BLOCK_SIZE, sizeof(next));
+		std::free(blocks);
+		blocks = next;
+	}
+}
+
+void *HostAllocator::allocate(const std::size_t size, std::size_t alignment, const VkSystemAllocationScope scope) {
+	alignment = std::max(alignment, alignof(std::max_align_t));
+	const std::size_t needed = size + sizeof(ChunkHeader) + alignment - 1;
+
+	std::uint32_t sizeClass = 0;
+	while (sizeClass < CLASS_COUNT && (MIN_CLASS_SIZE << sizeClass) < needed) {
+		++sizeClass;
+	}
+	void *chunk;
+	if (sizeClass < CLASS_COUNT) {
+		chunk = takeChunk(sizeClass);
+	} else {
+		sizeClass = LARGE_CLASS;
+		chunk = std::malloc(needed);
+	}
+	if (!chunk) {
+		return nullptr;
+	}
+
+	const auto address = reinterpret_cast<std::uintptr_t>(chunk) + sizeof(ChunkHeader);
+	auto *memory = reinterpret_cast<std::byte *>((address + alignment - 1) & ~(alignment - 1));
+	const ChunkHeader header{ chunk, size, sizeClass, static_cast<std::uint32_t>(scope) };
+	std::memcpy(memory - sizeof(ChunkHeader), &header, sizeof(header));
+
+	const auto index = scopeIndex(scope);
+	allocations[index].fetch_add(1, std::memory_order_relaxed);
+	bytesInUse[index].fetch_add(size, std::memory_order_relaxed);
+	return memory;
+}
+
+void *HostAllocator::reallocate(void *original, const std::size_t size, const std::size_t alignment, const VkSystemAllocationScope scope) {
+	if (!original) {
+		return allocate(size, alignment, scope);
+	}
+	if (size == 0) {
+		release(original);
+		return nullptr;
+	}
+	ChunkHeader header{};
+	std::memcpy(&header, static_cast<std::byte *>(original) - sizeof(ChunkHeader), sizeof(header));
+	void *memory = allocate(size, alignment, scope);
+	if (!memory) {
+		// The original allocation must be left untouched on failure.
+		return nullptr;
+	}
+	std::memcpy(memory, original, std::min(size, header.size));
+	release(original);
+	reallocations[scopeIndex(scope)].fetch_add(1, std::memory_order_relaxed);
+	return memory;
+}
+
+void HostAllocator::release(void *memory) {
+	if (!memory) {
+		return;
+	}
+	ChunkHeader header{};
+	std::memcpy(&header, static_cast<std::byte *>(memory) - sizeof(ChunkHeader), sizeof(header));
+	const auto index = scopeIndex(static_cast<VkSystemAllocationScope>(header.scope));
+	frees[index].fetch_add(1, std::memory_order_relaxed);
+	bytesInUse[index].fetch_sub(header.size, std::memory_order_relaxed);
+	if (header.sizeClass == LARGE_CLASS) {
+		std::free(header.chunk);
+	} else {
+		giveChunk(header.chunk, header.sizeClass);
+	}
+}
+
+void *HostAllocator::takeChunk(const std::size_t sizeClass) {
+	const std::lock_guard lock(mutex);
+	if (!freeLists[sizeClass]) {
+		// Carve a new block entirely into chunks, the link to the other blocks goes in the trailer past them.
+		auto *block = static_cast<std::byte *>(std::aligned_alloc(MIN_CLASS_SIZE, BLOCK_SIZE + BLOCK_LINK_SIZE));
+		if (!block) {
+			return nullptr;
+		}
+		std::memcpy(block + BLOCK_SIZE, &blocks, sizeof(blocks));
+		blocks = block;
+		const std::size_t chunkSize = MIN_CLASS_SIZE << sizeClass;
+		for (std::size_t offset = 0; offset + chunkSize <= BLOCK_SIZE; offset += chunkSize) {
+			std::memcpy(block + offset, &freeLists[sizeClass], sizeof(void *));
+			freeLists[sizeClass] = block + offset;
+		}
+	}
+	void *chunk = freeLists[sizeClass];
+	std::memcpy(&freeLists[sizeClass], chunk, sizeof(void *));
+	return chunk;
+}
+
+void HostAllocator::giveChunk(void *chunk, const std::size_t sizeClass) {
+	const std::lock_guard lock(mutex);
+	std::memcpy(chunk, &freeLists[sizeClass], sizeof(void *));
+	freeLists[sizeClass] = chunk;
+}
+
+HostAllocationStatistics HostAllocator::getStatistics() const noexcept {
+	HostAllocationStatistics statistics;
+	for (std::size_t i = 0; i < HostAllocationStatistics::SCOPE_COUNT; ++i) {
+		statistics.allocations[i] = allocations[i].load(std::memory_order_relaxed);
+		statistics.reallocations[i] = reallocations[i].load(std::memory_order_relaxed);
+		statistics.frees[i] = frees[i].load(std::memory_order_relaxed);
+		statistics.bytesInUse[i] = bytesInUse[i].load(std::memory_order_relaxed);
+		statistics.internalBytesInUse[i] = internalBytesInUse[i].load(std::memory_order_relaxed);
+	}
+	return statistics;
+}
+
+void *VKAPI_PTR HostAllocator::allocationCallback(void *pUserData, const size_t size, const size_t alignment, const VkSystemAllocationScope allocationScope) {
+	return static_cast<HostAllocator *>(pUserData)->allocate(size, alignment, allocationScope);
+}
+
+void *VKAPI_PTR HostAllocator::reallocationCallback(void *pUserData, void *pOriginal, const size_t size, const size_t alignment, const VkSystemAllocationScope allocationScope) {
+	return static_cast<HostAllocator *>(pUserData)->reallocate(pOriginal, size, alignment, allocationScope);
+}
+
+void VKAPI_PTR HostAllocator::freeCallback(void *pUserData, void *pMemory) {
+	static_cast<HostAllocator *>(pUserData)->release(pMemory);
+}
+
+void VKAPI_PTR HostAllocator::internalAllocationCallback(void *pUserData, const size_t size, VkInternalAllocationType, const VkSystemAllocationScope allocationScope) {
+	static_cast<HostAllocator *>(pUserData)->internalBytesInUse[scopeIndex(allocationScope)].fetch_add(size, std::memory_order_relaxed);
+}
+
+void VKAPI_PTR HostAllocator::internalFreeCallback(void *pUserData, const size_t size, VkInternalAllocationType, const VkSystemAllocationScope allocationScope) {
+	static_cast<HostAllocator *>(pUserData)->internalBytesInUse[scopeIndex(allocationScope)].fetch_sub(size, std::memory_order_relaxed);
+}
@@ -0,0 +1,102 @@
+#ifndef VULKANTUTORIAL_HOST_ALLOCATOR_H
+#define VULKANTUTORIAL_HOST_ALLOCATOR_H
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+/**
+ * \brief Number of calls to the global operator new (all forms) since the start of the program.
+ * The replacement operators are defined in host_allocator.cpp.
+ */
+std::uint64_t globalAllocationCount() noexcept;
+
+/**
+ * \brief Number of calls to the global operator delete (all forms) with a non null pointer since the start of the program.
+ */
+std::uint64_t globalDeallocationCount() noexcept;
+
+/**
+ * \brief Snapshot of the counters of a HostAllocator, indexed by VkSystemAllocationScope.
+ */
+struct HostAllocationStatistics {
+	static constexpr std::size_t SCOPE_COUNT = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+	std::array<std::uint64_t, SCOPE_COUNT> allocations{};
+	std::array<std::uint64_t, SCOPE_COUNT> reallocations{};
+	std::array<std::uint64_t, SCOPE_COUNT> frees{};
+	std::array<std::uint64_t, SCOPE_COUNT> bytesInUse{};
+	std::array<std::uint64_t, SCOPE_COUNT> internalBytesInUse{}; ///< Reported by the driver through the notifications.
+};
+
+const char *toString(VkSystemAllocationScope scope);
+
+/**
+ * @class HostAllocator
+ * \brief VkAllocationCallbacks backed by pools of fixed size chunks carved out of 64 KiB blocks, with counters per scope.
+ *
+ * Freed chunks go back to the free list of their size class, so once the driver has reached its steady state it does
+ * not reach the system allocator anymore. Requests above the largest class go straight to malloc. Thread safe : drivers
+ * may call it from their own threads. Must outlive every object created with getCallbacks().
+ */
+class HostAllocator {
+private:
+	static constexpr std::size_t CLASS_COUNT = 8; ///< 64 bytes to 8 KiB.
+	static constexpr std::size_t MIN_CLASS_SIZE = 64;
+	static constexpr std::size_t BLOCK_SIZE = 64 * 1024; ///< Bytes carved into chunks, a multiple of every class size.
+	/// Trailer after the chunks of each block, holding the link to the next block so that no chunk is spent on it.
+	static constexpr std::size_t BLOCK_LINK_SIZE = MIN_CLASS_SIZE;
+
+	vk::AllocationCallbacks callbacks;
+	std::mutex mutex;
+	std::array<void *, CLASS_COUNT> freeLists{};
+	void *blocks{ nullptr }; ///< Intrusive list : the trailer of each block points to the next one.
+
+	std::array<std::atomic<std::uint64_t>, HostAllocationStatistics::SCOPE_COUNT> allocations{};
+	std::array<std::atomic<std::uint64_t>, HostAllocationStatistics::SCOPE_COUNT> reallocations{};
+	std::array<std::atomic<std::uint64_t>, HostAllocationStatistics::SCOPE_COUNT> frees{};
+	std::array<std::atomic<std::uint64_t>, HostAllocationStatistics::SCOPE_COUNT> bytesInUse{};
+	std::array<std::atomic<std::uint64_t>, HostAllocationStatistics::SCOPE_COUNT> internalBytesInUse{};
+
+	void *allocate(std::size_t size, std::size_t alignment, VkSystemAllocationScope scope);
+
+	void *reallocate(void *original, std::size_t size, std::size_t alignment, VkSystemAllocationScope scope);
+
+	void release(void *memory);
+
+	void *takeChunk(std::size_t sizeClass);
+
+	void giveChunk(void *chunk, std::size_t sizeClass);
+
+	static void *VKAPI_PTR allocationCallback(void *pUserData, size_t size, size_t alignment, VkSystemAllocationScope allocationScope);
+
+	static void *VKAPI_PTR reallocationCallback(void *pUserData, void *pOriginal, size_t size, size_t alignment, VkSystemAllocationScope allocationScope);
+
+	static void VKAPI_PTR freeCallback(void *pUserData, void *pMemory);
+
+	static void VKAPI_PTR internalAllocationCallback(void *pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope allocationScope);
+
+	static void VKAPI_PTR internalFreeCallback(void *pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope allocationScope);
+
+public:
+	HostAllocator();
+
+	HostAllocator(const HostAllocator &) = delete;
+
+	HostAllocator &operator=(const HostAllocator &) = delete;
+
+	~HostAllocator();
+
+	[[nodiscard]] const vk::AllocationCallbacks &getCallbacks() const noexcept {
+		return callbacks;
+	}
+
+	[[nodiscard]] HostAllocationStatistics getStatistics() const noexcept;
+};
+
+#endif //VULKANTUTORIAL_HOST_ALLOCATOR_H
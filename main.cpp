@@ -1,14 +1,40 @@
+#include <charconv>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include "hello_triangle_app.h"
 
-int main() {
+int main(int argc, char **argv) {
 //	try {
-	HelloTriangleApp coucou("Hello", 1280, 720);
+	// Optional arguments : number of windows sharing the same device, and --capture file to record the frames.
+	std::size_t windowCount = 1;
+	std::string capturePath;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			capturePath = argv[++i];
+			continue;
+		}
+		const char *const last = argv[i] + std::strlen(argv[i]);
+		const auto [end, error] = std::from_chars(argv[i], last, windowCount);
+		// Each window is a pass of the draw keys, which have room for MAX_PASSES of them.
+		if (error != std::errc{} || end != last || windowCount == 0 || windowCount > DrawKey::MAX_PASSES) {
+			std::cerr << "usage: " << argv[0] << " [window count, 1 to " << DrawKey::MAX_PASSES << "] [--capture file]\n";
+			return EXIT_FAILURE;
+		}
+	}
+	HelloTriangleApp coucou("Hello", 1280, 720, windowCount);
+	if (!capturePath.empty()) {
+		coucou.startCapture(capturePath);
+	}
 	coucou.run();
+	// The frame loop must not touch the heap once warmed up, see HelloTriangleApp::mainLoop().
+	if (coucou.getAllocatingFrames() != 0) {
+		return EXIT_FAILURE;
+	}
 //	} catch (const std::exception &e) {
 //		std::cerr << e.what() << std::endl;
 //		return EXIT_FAILURE;
 //	}
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
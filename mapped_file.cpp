@@ -0,0 +1,51 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path) {
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		throw std::runtime_error("Failed to open " + path);
+	}
+	struct stat status{};
+	if (::fstat(fd, &status) != 0) {
+		::close(fd);
+		throw std::runtime_error("Failed to stat " + path);
+	}
+	this->length = static_cast<std::size_t>(status.st_size);
+	if (this->length > 0) {
+		void *address = ::mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED) {
+			::close(fd);
+			throw std::runtime_error("Failed to map " + path);
+		}
+		// Everything will be read shortly, by several threads at once : start reading it in now.
+		::madvise(address, this->length, MADV_WILLNEED);
+		this->mapping = static_cast<const std::byte *>(address);
+	}
+	::close(fd); // The mapping keeps its own reference on the file.
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+		mapping(std::exchange(other.mapping, nullptr)), length(std::exchange(other.length, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+	if (this != &other) {
+		if (this->mapping) {
+			::munmap(const_cast<std::byte *>(this->mapping), this->length);
+		}
+		this->mapping = std::exchange(other.mapping, nullptr);
+		this->length = std::exchange(other.length, 0);
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile() {
+	if (this->mapping) {
+		::munmap(const_cast<std::byte *>(this->mapping), this->length);
+	}
+}
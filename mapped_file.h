@@ -0,0 +1,48 @@
+#ifndef VULKANTUTORIAL_MAPPED_FILE_H
+#define VULKANTUTORIAL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * \brief Read only memory mapping of a whole file. The mapping lives as long as the object.
+ */
+class MappedFile {
+private:
+	const std::byte *mapping{ nullptr };
+	std::size_t length{ 0 };
+
+public:
+	MappedFile() = default;
+
+	/**
+	 * \param path
+	 * \throw std::runtime_error if the file cannot be opened or mapped.
+	 */
+	explicit MappedFile(const std::string &path);
+
+	MappedFile(const MappedFile &) = delete;
+
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	MappedFile(MappedFile &&other) noexcept;
+
+	MappedFile &operator=(MappedFile &&other) noexcept;
+
+	~MappedFile();
+
+	[[nodiscard]] const std::byte *data() const noexcept {
+		return mapping;
+	}
+
+	[[nodiscard]] const char *chars() const noexcept {
+		return reinterpret_cast<const char *>(mapping);
+	}
+
+	[[nodiscard]] std::size_t size() const noexcept {
+		return length;
+	}
+};
+
+#endif //VULKANTUTORIAL_MAPPED_FILE_H
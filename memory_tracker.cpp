@@ -0,0 +1,151 @@
+#include "memory_tracker.h"
+#include "memory_utils.h"
+#include <algorithm>
+#include <utility>
+
+const char *toString(const MemoryCategory category) {
+	switch (category) {
+		case MemoryCategory::Buffer:
+			return "buffer";
+		case MemoryCategory::Image:
+			return "image";
+		case MemoryCategory::Swapchain:
+			return "swapchain";
+		default:
+			return "unknown";
+	}
+}
+
+TrackedMemory::TrackedMemory(vk::UniqueDeviceMemory memory, MemoryTracker &tracker, const vk::DeviceSize size, const std::uint32_t heapIndex, const MemoryCategory category) noexcept :
+		memory(std::move(memory)), tracker(&tracker), size(size), heapIndex(heapIndex), category(category) {}
+
+TrackedMemory::TrackedMemory(TrackedMemory &&other) noexcept :
+		memory(std::move(other.memory)), tracker(std::exchange(other.tracker, nullptr)), size(other.size), heapIndex(other.heapIndex), category(other.category) {}
+
+TrackedMemory &TrackedMemory::operator=(TrackedMemory &&other) noexcept {
+	if (this != &other) {
+		reset();
+		this->memory = std::move(other.memory);
+		this->tracker = std::exchange(other.tracker, nullptr);
+		this->size = other.size;
+		this->heapIndex = other.heapIndex;
+		this->category = other.category;
+	}
+	return *this;
+}
+
+TrackedMemory::~TrackedMemory() {
+	reset();
+}
+
+void TrackedMemory::reset() noexcept {
+	if (this->tracker && this->memory) {
+		this->tracker->release(heapIndex, category, size);
+	}
+	this->tracker = nullptr;
+	this->memory.reset();
+}
+
+MemoryTracker::MemoryTracker(const vk::PhysicalDevice &physicalDevice, const bool budgetExtension) :
+		physicalDevice(physicalDevice), memoryProperties(physicalDevice.getMemoryProperties()), budgetExtension(budgetExtension) {
+	heaps.resize(memoryProperties.memoryHeapCount);
+	for (std::uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i) {
+		heaps[i].size = memoryProperties.memoryHeaps[i].size;
+		heaps[i].deviceLocal = static_cast<bool>(memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+	}
+	poll();
+}
+
+TrackedMemory MemoryTracker::allocate(const vk::Device &device, const vk::MemoryRequirements &requirements, const vk::MemoryPropertyFlags properties, const MemoryCategory category) {
+	const auto memoryType = findMemoryType(physicalDevice, requirements.memoryTypeBits, properties);
+	const auto heapIndex = heapOfType(memoryType);
+	// Warn before the allocation : what is optional can still be released to make room for it.
+	updatePressure(heapIndex, requirements.size);
+	auto memory = device.allocateMemoryUnique(vk::MemoryAllocateInfo{ requirements.size, memoryType });
+	record(heapIndex, category, requirements.size);
+	return TrackedMemory(std::move(memory), *this, requirements.size, heapIndex, category);
+}
+
+void MemoryTracker::record(const std::uint32_t heapIndex, const MemoryCategory category, const vk::DeviceSize size) {
+	auto &heap = heaps[heapIndex];
+	heap.tracked += size;
+	heap.byCategory[static_cast<std::size_t>(category)] += size;
+	// Kept current between two polls, the next poll() reads the real usage back from the driver.
+	heap.usage += size;
+}
+
+void MemoryTracker::release(const std::uint32_t heapIndex, const MemoryCategory category, const vk::DeviceSize size) noexcept {
+	auto &heap = heaps[heapIndex];
+	heap.tracked -= std::min(heap.tracked, size);
+	auto &categoryBytes = heap.byCategory[static_cast<std::size_t>(category)];
+	categoryBytes -= std::min(categoryBytes, size);
+	heap.usage -= std::min(heap.usage, size);
+	if (heap.underPressure) {
+		updatePressure(heapIndex, 0);
+	}
+}
+
+void MemoryTracker::poll() {
+	if (budgetExtension) {
+		const auto chain = physicalDevice.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+		const auto &budgetProperties = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+		for (std::uint32_t i = 0; i < heaps.size(); ++i) {
+			heaps[i].budget = budgetProperties.heapBudget[i];
+			heaps[i].usage = budgetProperties.heapUsage[i];
+		}
+	} else {
+		for (auto &heap : heaps) {
+			heap.budget = static_cast<vk::DeviceSize>(static_cast<double>(heap.size) * DEFAULT_BUDGET_RATIO);
+			heap.usage = heap.tracked;
+		}
+	}
+	for (std::uint32_t i = 0; i < heaps.size(); ++i) {
+		updatePressure(i, 0);
+	}
+}
+
+void MemoryTracker::updatePressure(const std::uint32_t heapIndex, const vk::DeviceSize incoming) {
+	auto &heap = heaps[heapIndex];
+	if (heap.budget == 0) {
+		return;
+	}
+	const auto usage = static_cast<double>(heap.usage + incoming);
+	const auto budget = static_cast<double>(heap.budget);
+	if (!heap.underPressure && usage > budget * pressureThreshold) {
+		heap.underPressure = true;
+		for (const auto &callback : pressureCallbacks) {
+			callback(heapIndex, heap);
+		}
+	} else if (heap.underPressure && usage <= budget * (pressureThreshold - PRESSURE_HYSTERESIS)) {
+		heap.underPressure = false;
+	}
+}
+
+std::uint32_t MemoryTracker::deviceLocalHeap() const noexcept {
+	for (std::uint32_t i = 0; i < heaps.size(); ++i) {
+		if (heaps[i].deviceLocal) {
+			return i;
+		}
+	}
+	return 0;
+}
+
+void MemoryTracker::writeStatistics(std::ostream &out) const {
+	out << "{ \"budget_extension\": " << (budgetExtension ? "true" : "false") << ", \"heaps\": [";
+	for (std::size_t i = 0; i < heaps.size(); ++i) {
+		const auto &heap = heaps[i];
+		out << (i == 0 ? " " : ", ")
+			<< "{ \"index\": " << i
+			<< ", \"device_local\": " << (heap.deviceLocal ? "true" : "false")
+			<< ", \"size\": " << heap.size
+			<< ", \"budget\": " << heap.budget
+			<< ", \"usage\": " << heap.usage
+			<< ", \"tracked\": " << heap.tracked
+			<< ", \"under_pressure\": " << (heap.underPressure ? "true" : "false");
+		for (std::size_t c = 0; c < heap.byCategory.size(); ++c) {
+			out << ", \"" << toString(static_cast<MemoryCategory>(c)) << "\": " << heap.byCategory[c];
+		}
+		out << " }";
+	}
+	out << " ] }";
+}
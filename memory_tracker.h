@@ -0,0 +1,161 @@
+#ifndef VULKANTUTORIAL_MEMORY_TRACKER_H
+#define VULKANTUTORIAL_MEMORY_TRACKER_H
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+enum class MemoryCategory : std::uint8_t {
+	Buffer,
+	Image,
+	Swapchain, ///< Estimated, without VK_EXT_memory_budget only : the driver allocates swapchain images itself.
+	Count
+};
+
+const char *toString(MemoryCategory category);
+
+struct HeapStatistics {
+	vk::DeviceSize size{ 0 };
+	vk::DeviceSize budget{ 0 }; ///< From VK_EXT_memory_budget, or a fraction of size without it.
+	/// Whole process as seen by the driver at the last poll, plus what was tracked since. What is tracked without VK_EXT_memory_budget.
+	vk::DeviceSize usage{ 0 };
+	vk::DeviceSize tracked{ 0 };
+	std::array<vk::DeviceSize, static_cast<std::size_t>(MemoryCategory::Count)> byCategory{};
+	bool deviceLocal{ false };
+	bool underPressure{ false }; ///< Set when the pressure callbacks fired, cleared once usage is back under the re-arm level.
+};
+
+class MemoryTracker;
+
+/**
+ * @class TrackedMemory
+ * \brief vk::UniqueDeviceMemory which gives its size back to the MemoryTracker when freed.
+ */
+class TrackedMemory {
+private:
+	vk::UniqueDeviceMemory memory;
+	MemoryTracker *tracker{ nullptr };
+	vk::DeviceSize size{ 0 };
+	std::uint32_t heapIndex{ 0 };
+	MemoryCategory category{ MemoryCategory::Buffer };
+
+public:
+	TrackedMemory() = default;
+
+	TrackedMemory(vk::UniqueDeviceMemory memory, MemoryTracker &tracker, vk::DeviceSize size, std::uint32_t heapIndex, MemoryCategory category) noexcept;
+
+	TrackedMemory(TrackedMemory &&other) noexcept;
+
+	TrackedMemory &operator=(TrackedMemory &&other) noexcept;
+
+	~TrackedMemory();
+
+	void reset() noexcept;
+
+	[[nodiscard]] vk::DeviceMemory operator*() const noexcept {
+		return *memory;
+	}
+
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(memory);
+	}
+};
+
+/**
+ * @class MemoryTracker
+ * \brief Accounting of the device memory per heap and per category, compared to the budget given by VK_EXT_memory_budget.
+ *
+ * Pressure callbacks are fired when a heap goes above pressureThreshold of its budget, either when polling or right before
+ * an allocation that would cross it, so that optional resources (mips, caches…) can be shed first. They fire once per
+ * crossing : a heap has to fall PRESSURE_HYSTERESIS below the threshold before they can fire again. Not thread safe : all
+ * allocations go through the render thread.
+ */
+class MemoryTracker {
+public:
+	using PressureCallback = std::function<void(std::uint32_t heapIndex, const HeapStatistics &statistics)>;
+
+	/// Budget assumed for a heap when VK_EXT_memory_budget is not available, as a fraction of its size.
+	static constexpr double DEFAULT_BUDGET_RATIO = 0.8;
+	/// Fraction of the budget a heap under pressure has to go below the threshold to re-arm the callbacks.
+	static constexpr double PRESSURE_HYSTERESIS = 0.05;
+
+private:
+	vk::PhysicalDevice physicalDevice;
+	vk::PhysicalDeviceMemoryProperties memoryProperties;
+	bool budgetExtension{ false };
+	double pressureThreshold{ 0.9 };
+	std::vector<HeapStatistics> heaps;
+	std::vector<PressureCallback> pressureCallbacks;
+
+	/**
+	 * \brief Fire the pressure callbacks if incoming more bytes take the heap above the threshold for the first time
+	 * since it was last re-armed, or re-arm them if the heap is far enough below.
+	 */
+	void updatePressure(std::uint32_t heapIndex, vk::DeviceSize incoming);
+
+public:
+	MemoryTracker() = default;
+
+	/**
+	 * \param physicalDevice
+	 * \param budgetExtension true if VK_EXT_memory_budget has been enabled on the device.
+	 */
+	MemoryTracker(const vk::PhysicalDevice &physicalDevice, bool budgetExtension);
+
+	/**
+	 * \brief Allocate memory of the first type matching the properties, and record it.
+	 */
+	[[nodiscard]] TrackedMemory allocate(const vk::Device &device, const vk::MemoryRequirements &requirements, vk::MemoryPropertyFlags properties, MemoryCategory category);
+
+	/**
+	 * \brief Record memory allocated by somebody else (the swapchain images of the driver…).
+	 */
+	void record(std::uint32_t heapIndex, MemoryCategory category, vk::DeviceSize size);
+
+	void release(std::uint32_t heapIndex, MemoryCategory category, vk::DeviceSize size) noexcept;
+
+	/**
+	 * \brief Refresh the usage and budget of every heap, then fire or re-arm the pressure callbacks.
+	 */
+	void poll();
+
+	void addPressureCallback(PressureCallback callback) {
+		pressureCallbacks.push_back(std::move(callback));
+	}
+
+	/**
+	 * \param threshold fraction of the budget above which a heap is under pressure.
+	 */
+	void setPressureThreshold(const double threshold) noexcept {
+		pressureThreshold = threshold;
+	}
+
+	[[nodiscard]] std::uint32_t heapOfType(std::uint32_t memoryTypeIndex) const noexcept {
+		return memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+	}
+
+	/**
+	 * \brief First device local heap, where the swapchain images live.
+	 */
+	[[nodiscard]] std::uint32_t deviceLocalHeap() const noexcept;
+
+	[[nodiscard]] const std::vector<HeapStatistics> &getHeapStatistics() const noexcept {
+		return heaps;
+	}
+
+	[[nodiscard]] bool hasBudgetExtension() const noexcept {
+		return budgetExtension;
+	}
+
+	/**
+	 * \brief Dump the statistics of every heap as JSON.
+	 */
+	void writeStatistics(std::ostream &out) const;
+};
+
+#endif //VULKANTUTORIAL_MEMORY_TRACKER_H
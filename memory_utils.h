@@ -0,0 +1,42 @@
+#ifndef VULKANTUTORIAL_MEMORY_UTILS_H
+#define VULKANTUTORIAL_MEMORY_UTILS_H
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * \brief First memory type allowed by typeFilter having all the properties asked.
+ */
+inline std::uint32_t findMemoryType(const vk::PhysicalDevice &physicalDevice, const std::uint32_t typeFilter, const vk::MemoryPropertyFlags properties) {
+	const auto memProperties = physicalDevice.getMemoryProperties();
+	for (std::uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+		if ((typeFilter & (1u << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+	throw std::runtime_error("Failed to find a suitable memory type.");
+}
+
+/**
+ * \brief Append VK_EXT_memory_budget to the device extensions if physicalDevice supports it. It is optional : without it
+ * MemoryTracker only estimates the budget from the heap sizes.
+ * \return whether it was appended, to be given to MemoryTracker.
+ */
+inline bool enableMemoryBudget(const vk::PhysicalDevice &physicalDevice, std::vector<const char *> &extensions) {
+	const auto availableExtensions = physicalDevice.enumerateDeviceExtensionProperties();
+	const bool supported = std::any_of(availableExtensions.cbegin(), availableExtensions.cend(), [](const vk::ExtensionProperties &extension) {
+		return std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+	});
+	if (supported) {
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+	return supported;
+}
+
+#endif //VULKANTUTORIAL_MEMORY_UTILS_H
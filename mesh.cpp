@@ -0,0 +1,509 @@
+#include "mesh.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <omp.h>
+
+namespace {
+	constexpr std::int32_t noIndex = -1;
+
+	/**
+	 * \brief Face corner of an OBJ file. While parsing, negative OBJ indices are stored relative to the start of the
+	 * chunk with their bit set in relative, since the number of elements of the previous chunks is not known yet.
+	 */
+	struct ObjCorner {
+		std::int32_t position{ noIndex };
+		std::int32_t uv{ noIndex };
+		std::int32_t normal{ noIndex };
+		std::uint8_t relative{ 0 };
+
+		static constexpr std::uint8_t RELATIVE_POSITION = 1u << 0;
+		static constexpr std::uint8_t RELATIVE_UV = 1u << 1;
+		static constexpr std::uint8_t RELATIVE_NORMAL = 1u << 2;
+
+		bool operator==(const ObjCorner &other) const noexcept {
+			return position == other.position && uv == other.uv && normal == other.normal;
+		}
+	};
+
+	struct ObjCornerHash {
+		std::size_t operator()(const ObjCorner &corner) const noexcept {
+			std::uint64_t hash = static_cast<std::uint32_t>(corner.position);
+			hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(corner.uv);
+			hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(corner.normal);
+			return static_cast<std::size_t>(hash ^ (hash >> 29));
+		}
+	};
+
+	/**
+	 * \brief What one thread extracts from its part of the file.
+	 */
+	struct ObjChunk {
+		std::vector<float> positions; ///< 3 per vertex.
+		std::vector<float> uvs;       ///< 2 per vertex.
+		std::vector<float> normals;   ///< 3 per vertex.
+		std::vector<ObjCorner> corners; ///< 3 per triangle.
+	};
+
+	[[gnu::always_inline]] inline const char *skipSpaces(const char *it, const char *end) {
+		while (it < end && (*it == ' ' || *it == '\t')) {
+			++it;
+		}
+		return it;
+	}
+
+	[[gnu::always_inline]] inline const char *nextLine(const char *it, const char *end) {
+		const auto *newLine = static_cast<const char *>(std::memchr(it, '\n', static_cast<std::size_t>(end - it)));
+		return newLine ? newLine + 1 : end;
+	}
+
+	const char *parseFloats(const char *it, const char *end, const std::size_t count, std::vector<float> &out) {
+		for (std::size_t i = 0; i < count; ++i) {
+			it = skipSpaces(it, end);
+			float value = 0.f;
+			const auto result = std::from_chars(it, end, value);
+			it = result.ptr;
+			out.push_back(value);
+		}
+		return it;
+	}
+
+	/**
+	 * \brief OBJ index (1 based, or negative from the last element) to index inside the file or inside the chunk.
+	 */
+	[[gnu::always_inline]] inline std::int32_t toIndex(const int value, const std::size_t chunkCount, std::uint8_t &relative, const std::uint8_t bit) {
+		if (value > 0) {
+			return value - 1;
+		} else if (value < 0) {
+			relative |= bit;
+			return static_cast<std::int32_t>(chunkCount) + value;
+		}
+		return noIndex;
+	}
+
+	const char *parseFace(const char *it, const char *end, ObjChunk &chunk, std::vector<ObjCorner> &polygon) {
+		polygon.clear();
+		while (true) {
+			it = skipSpaces(it, end);
+			if (it >= end || *it == '\n' || *it == '\r' || *it == '#') {
+				break;
+			}
+			ObjCorner corner;
+			int value = 0;
+			auto result = std::from_chars(it, end, value);
+			if (result.ec != std::errc{}) {
+				break;
+			}
+			it = result.ptr;
+			corner.position = toIndex(value, chunk.positions.size() / 3, corner.relative, ObjCorner::RELATIVE_POSITION);
+			if (it < end && *it == '/') {
+				++it;
+				if (it < end && *it != '/') {
+					value = 0;
+					result = std::from_chars(it, end, value);
+					it = result.ptr;
+					corner.uv = toIndex(value, chunk.uvs.size() / 2, corner.relative, ObjCorner::RELATIVE_UV);
+				}
+				if (it < end && *it == '/') {
+					++it;
+					value = 0;
+					result = std::from_chars(it, end, value);
+					it = result.ptr;
+					corner.normal = toIndex(value, chunk.normals.size() / 3, corner.relative, ObjCorner::RELATIVE_NORMAL);
+				}
+			}
+			polygon.push_back(corner);
+		}
+		// Polygons are triangulated as fans.
+		for (std::size_t i = 1; i + 1 < polygon.size(); ++i) {
+			chunk.corners.push_back(polygon[0]);
+			chunk.corners.push_back(polygon[i]);
+			chunk.corners.push_back(polygon[i + 1]);
+		}
+		return it;
+	}
+
+	void parseChunk(const char *it, const char *end, ObjChunk &chunk) {
+		std::vector<ObjCorner> polygon;
+		while (it < end) {
+			it = skipSpaces(it, end);
+			if (end - it > 2 && it[0] == 'v' && (it[1] == ' ' || it[1] == '\t')) {
+				it = parseFloats(it + 2, end, 3, chunk.positions);
+			} else if (end - it > 3 && it[0] == 'v' && it[1] == 't' && (it[2] == ' ' || it[2] == '\t')) {
+				it = parseFloats(it + 3, end, 2, chunk.uvs);
+			} else if (end - it > 3 && it[0] == 'v' && it[1] == 'n' && (it[2] == ' ' || it[2] == '\t')) {
+				it = parseFloats(it + 3, end, 3, chunk.normals);
+			} else if (end - it > 2 && it[0] == 'f' && (it[1] == ' ' || it[1] == '\t')) {
+				it = parseFace(it + 2, end, chunk, polygon);
+			}
+			// Comments, groups, materials… and whatever is left of the line are skipped.
+			it = nextLine(it, end);
+		}
+	}
+
+	/**
+	 * \brief Turn a chunk index into a file index and check it.
+	 * \return false if the index is out of range, or missing when required.
+	 */
+	[[gnu::always_inline]] inline bool resolve(std::int32_t &index, const bool relative, const std::size_t chunkOffset, const std::size_t count, const bool required) {
+		if (index == noIndex && !relative) {
+			return !required;
+		}
+		const auto absolute = relative ? static_cast<std::int64_t>(chunkOffset) + index : static_cast<std::int64_t>(index);
+		if (absolute < 0 || absolute >= static_cast<std::int64_t>(count)) {
+			return false;
+		}
+		index = static_cast<std::int32_t>(absolute);
+		return true;
+	}
+
+	template<typename T>
+	void prefixSum(const std::vector<ObjChunk> &chunks, std::vector<std::size_t> &offsets, T &&count) {
+		offsets.assign(chunks.size() + 1, 0);
+		for (std::size_t i = 0; i < chunks.size(); ++i) {
+			offsets[i + 1] = offsets[i] + count(chunks[i]);
+		}
+	}
+
+	[[gnu::always_inline]] inline std::int16_t toSnorm16(const float value) {
+		return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+	}
+
+	[[gnu::always_inline]] inline std::int8_t toSnorm8(const float value) {
+		return static_cast<std::int8_t>(std::lround(std::clamp(value, -1.f, 1.f) * 127.f));
+	}
+
+	[[gnu::always_inline]] inline std::uint16_t toUnorm16(const float value) {
+		return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.f, 1.f) * 65535.f));
+	}
+
+	[[gnu::always_inline]] inline std::uint64_t alignUp(const std::uint64_t value, const std::uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	/**
+	 * \brief Whether count elements of stride bytes starting at offset lie within size bytes, without overflowing.
+	 */
+	[[gnu::always_inline]] inline bool fitsIn(const std::uint64_t offset, const std::uint64_t count, const std::uint64_t stride, const std::uint64_t size) {
+		return offset <= size && (count == 0 || count <= (size - offset) / stride);
+	}
+}
+
+MeshData loadObj(const std::string &path) {
+	const MappedFile file(path);
+	const char *const begin = file.chars();
+	const char *const end = begin + file.size();
+
+	// A few chunks per thread, split at line boundaries, to balance files whose lines are of very different kinds.
+	const auto chunkCount = static_cast<std::size_t>(std::max(1, omp_get_max_threads() * 4));
+	std::vector<const char *> bounds(chunkCount + 1, end);
+	bounds[0] = begin;
+	for (std::size_t i = 1; i < chunkCount; ++i) {
+		const char *split = std::max(bounds[i - 1], begin + file.size() / chunkCount * i);
+		bounds[i] = split < end ? nextLine(split, end) : end;
+	}
+
+	std::vector<ObjChunk> chunks(chunkCount);
+#pragma omp parallel for schedule(dynamic, 1)
+	for (std::int64_t i = 0; i < static_cast<std::int64_t>(chunkCount); ++i) {
+		parseChunk(bounds[i], bounds[i + 1], chunks[i]);
+	}
+
+	std::vector<std::size_t> positionOffsets, uvOffsets, normalOffsets, cornerOffsets;
+	prefixSum(chunks, positionOffsets, [](const ObjChunk &chunk) { return chunk.positions.size() / 3; });
+	prefixSum(chunks, uvOffsets, [](const ObjChunk &chunk) { return chunk.uvs.size() / 2; });
+	prefixSum(chunks, normalOffsets, [](const ObjChunk &chunk) { return chunk.normals.size() / 3; });
+	prefixSum(chunks, cornerOffsets, [](const ObjChunk &chunk) { return chunk.corners.size(); });
+
+	std::vector<float> positions(positionOffsets.back() * 3), uvs(uvOffsets.back() * 2), normals(normalOffsets.back() * 3);
+	std::vector<ObjCorner> corners(cornerOffsets.back());
+	bool malformed = false;
+#pragma omp parallel for schedule(dynamic, 1) reduction(||: malformed)
+	for (std::int64_t i = 0; i < static_cast<std::int64_t>(chunkCount); ++i) {
+		const auto &chunk = chunks[i];
+		std::copy(chunk.positions.cbegin(), chunk.positions.cend(), positions.begin() + static_cast<std::ptrdiff_t>(positionOffsets[i] * 3));
+		std::copy(chunk.uvs.cbegin(), chunk.uvs.cend(), uvs.begin() + static_cast<std::ptrdiff_t>(uvOffsets[i] * 2));
+		std::copy(chunk.normals.cbegin(), chunk.normals.cend(), normals.begin() + static_cast<std::ptrdiff_t>(normalOffsets[i] * 3));
+		for (std::size_t j = 0; j < chunk.corners.size(); ++j) {
+			auto corner = chunk.corners[j];
+			malformed = malformed
+						|| !resolve(corner.position, corner.relative & ObjCorner::RELATIVE_POSITION, positionOffsets[i], positionOffsets.back(), true)
+						|| !resolve(corner.uv, corner.relative & ObjCorner::RELATIVE_UV, uvOffsets[i], uvOffsets.back(), false)
+						|| !resolve(corner.normal, corner.relative & ObjCorner::RELATIVE_NORMAL, normalOffsets[i], normalOffsets.back(), false);
+			corner.relative = 0;
+			corners[cornerOffsets[i] + j] = corner;
+		}
+	}
+	if (malformed) {
+		throw std::runtime_error("Malformed face indices in " + path);
+	}
+	chunks.clear();
+
+	// Same position/uv/normal triplet : same vertex.
+	MeshData mesh;
+	mesh.indices.reserve(corners.size());
+	std::unordered_map<ObjCorner, std::uint32_t, ObjCornerHash> uniqueVertices;
+	uniqueVertices.reserve(corners.size() / 2);
+	for (const auto &corner : corners) {
+		const auto[it, inserted] = uniqueVertices.try_emplace(corner, static_cast<std::uint32_t>(mesh.vertices.size()));
+		if (inserted) {
+			MeshVertex vertex{};
+			std::copy_n(&positions[static_cast<std::size_t>(corner.position) * 3], 3, vertex.position);
+			if (corner.normal != noIndex) {
+				std::copy_n(&normals[static_cast<std::size_t>(corner.normal) * 3], 3, vertex.normal);
+			}
+			if (corner.uv != noIndex) {
+				std::copy_n(&uvs[static_cast<std::size_t>(corner.uv) * 2], 2, vertex.uv);
+			}
+			mesh.vertices.push_back(vertex);
+		}
+		mesh.indices.push_back(it->second);
+	}
+	return mesh;
+}
+
+void optimizeVertexCache(std::vector<std::uint32_t> &indices, const std::size_t vertexCount, std::size_t cacheSize) {
+	const std::size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0) {
+		return;
+	}
+	cacheSize = std::max<std::size_t>(cacheSize, 4);
+
+	// Triangles using each vertex, in compressed rows. The first liveTriangles[v] entries of a row are not emitted yet.
+	std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (const auto index : indices) {
+		++adjacencyOffsets[index + 1];
+	}
+	for (std::size_t v = 0; v < vertexCount; ++v) {
+		adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+	}
+	std::vector<std::uint32_t> adjacency(triangleCount * 3);
+	std::vector<std::uint32_t> liveTriangles(vertexCount);
+	for (std::size_t v = 0; v < vertexCount; ++v) {
+		liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+	}
+	{
+		std::vector<std::uint32_t> fill(adjacencyOffsets.cbegin(), adjacencyOffsets.cend() - 1);
+		for (std::size_t t = 0; t < triangleCount; ++t) {
+			for (std::size_t k = 0; k < 3; ++k) {
+				adjacency[fill[indices[t * 3 + k]]++] = static_cast<std::uint32_t>(t);
+			}
+		}
+	}
+
+	// Forsyth's scoring : recently used vertices and vertices with few triangles left are preferred.
+	const auto vertexScore = [cacheSize](const std::int64_t cachePosition, const std::uint32_t live) {
+		if (live == 0) {
+			return -1.f;
+		}
+		float score = 0.f;
+		if (cachePosition >= 0) {
+			score = cachePosition < 3 ? 0.75f
+									  : std::pow(1.f - static_cast<float>(cachePosition - 3) / static_cast<float>(cacheSize - 3), 1.5f);
+		}
+		return score + 2.f / std::sqrt(static_cast<float>(live));
+	};
+
+	std::vector<float> vertexScores(vertexCount);
+	for (std::size_t v = 0; v < vertexCount; ++v) {
+		vertexScores[v] = vertexScore(-1, liveTriangles[v]);
+	}
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<std::uint32_t> cache, nextCache;
+	cache.reserve(cacheSize + 3);
+	nextCache.reserve(cacheSize + 3);
+	std::vector<std::uint32_t> result;
+	result.reserve(triangleCount * 3);
+
+	std::size_t cursor = 0;
+	std::int64_t best = -1;
+	while (result.size() < triangleCount * 3) {
+		if (best < 0) {
+			// Nothing left around the cache : restart from the first triangle not emitted.
+			while (emitted[cursor]) {
+				++cursor;
+			}
+			best = static_cast<std::int64_t>(cursor);
+		}
+		const auto triangle = static_cast<std::size_t>(best);
+		emitted[triangle] = true;
+		const std::uint32_t *corners = &indices[triangle * 3];
+		result.insert(result.end(), corners, corners + 3);
+
+		nextCache.clear();
+		for (std::size_t k = 0; k < 3; ++k) {
+			const auto v = corners[k];
+			const auto rowBegin = adjacency.begin() + adjacencyOffsets[v];
+			const auto rowEnd = rowBegin + liveTriangles[v];
+			const auto found = std::find(rowBegin, rowEnd, static_cast<std::uint32_t>(triangle));
+			if (found != rowEnd) {
+				std::iter_swap(found, rowEnd - 1);
+				--liveTriangles[v];
+			}
+			if (std::find(nextCache.cbegin(), nextCache.cend(), v) == nextCache.cend()) {
+				nextCache.push_back(v);
+			}
+		}
+		for (const auto v : cache) {
+			if (std::find(corners, corners + 3, v) == corners + 3) {
+				nextCache.push_back(v);
+			}
+		}
+		for (std::size_t i = cacheSize; i < nextCache.size(); ++i) {
+			vertexScores[nextCache[i]] = vertexScore(-1, liveTriangles[nextCache[i]]);
+		}
+		nextCache.resize(std::min(nextCache.size(), cacheSize));
+		cache.swap(nextCache);
+		for (std::size_t i = 0; i < cache.size(); ++i) {
+			vertexScores[cache[i]] = vertexScore(static_cast<std::int64_t>(i), liveTriangles[cache[i]]);
+		}
+
+		best = -1;
+		float bestScore = -std::numeric_limits<float>::infinity();
+		for (const auto v : cache) {
+			for (std::uint32_t a = 0; a < liveTriangles[v]; ++a) {
+				const auto candidate = adjacency[adjacencyOffsets[v] + a];
+				const float score = vertexScores[indices[candidate * 3]]
+									+ vertexScores[indices[candidate * 3 + 1]]
+									+ vertexScores[indices[candidate * 3 + 2]];
+				if (score > bestScore) {
+					bestScore = score;
+					best = candidate;
+				}
+			}
+		}
+	}
+	indices.swap(result);
+}
+
+void optimizeVertexFetch(MeshData &mesh) {
+	constexpr auto unused = std::numeric_limits<std::uint32_t>::max();
+	std::vector<std::uint32_t> remap(mesh.vertices.size(), unused);
+	std::vector<MeshVertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+	for (auto &index : mesh.indices) {
+		if (remap[index] == unused) {
+			remap[index] = static_cast<std::uint32_t>(vertices.size());
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+	mesh.vertices.swap(vertices); // Vertices no triangle uses are dropped on the way.
+}
+
+MeshData importMesh(const std::string &path) {
+	auto mesh = loadObj(path);
+	optimizeVertexCache(mesh.indices, mesh.vertices.size());
+	optimizeVertexFetch(mesh);
+	return mesh;
+}
+
+void writeMeshCache(const std::string &path, const MeshData &mesh, const bool quantize) {
+	MeshCacheHeader header;
+	header.flags = quantize ? MeshCacheHeader::QUANTIZED : 0;
+	header.vertexStride = quantize ? sizeof(QuantizedVertex) : sizeof(MeshVertex);
+	header.vertexCount = mesh.vertices.size();
+	header.indexCount = mesh.indices.size();
+	header.vertexOffset = alignUp(sizeof(MeshCacheHeader), 16);
+	header.indexOffset = alignUp(header.vertexOffset + header.vertexCount * header.vertexStride, 16);
+
+	std::fill_n(header.positionMin, 3, std::numeric_limits<float>::max());
+	std::fill_n(header.positionMax, 3, std::numeric_limits<float>::lowest());
+	std::fill_n(header.uvMin, 2, std::numeric_limits<float>::max());
+	std::fill_n(header.uvMax, 2, std::numeric_limits<float>::lowest());
+	for (const auto &vertex : mesh.vertices) {
+		for (std::size_t i = 0; i < 3; ++i) {
+			header.positionMin[i] = std::min(header.positionMin[i], vertex.position[i]);
+			header.positionMax[i] = std::max(header.positionMax[i], vertex.position[i]);
+		}
+		for (std::size_t i = 0; i < 2; ++i) {
+			header.uvMin[i] = std::min(header.uvMin[i], vertex.uv[i]);
+			header.uvMax[i] = std::max(header.uvMax[i], vertex.uv[i]);
+		}
+	}
+
+	std::vector<char> bytes(header.indexOffset + header.indexCount * sizeof(std::uint32_t), 0);
+	std::memcpy(bytes.data(), &header, sizeof(header));
+	if (quantize) {
+		auto *out = reinterpret_cast<QuantizedVertex *>(bytes.data() + header.vertexOffset);
+		float center[3], halfExtent[3], uvExtent[2];
+		for (std::size_t i = 0; i < 3; ++i) {
+			center[i] = (header.positionMin[i] + header.positionMax[i]) * 0.5f;
+			halfExtent[i] = (header.positionMax[i] - header.positionMin[i]) * 0.5f;
+		}
+		for (std::size_t i = 0; i < 2; ++i) {
+			uvExtent[i] = header.uvMax[i] - header.uvMin[i];
+		}
+#pragma omp parallel for
+		for (std::int64_t v = 0; v < static_cast<std::int64_t>(mesh.vertices.size()); ++v) {
+			const auto &vertex = mesh.vertices[v];
+			QuantizedVertex quantized{};
+			for (std::size_t i = 0; i < 3; ++i) {
+				quantized.position[i] = halfExtent[i] > 0.f ? toSnorm16((vertex.position[i] - center[i]) / halfExtent[i]) : 0;
+				quantized.normal[i] = toSnorm8(vertex.normal[i]);
+			}
+			for (std::size_t i = 0; i < 2; ++i) {
+				quantized.uv[i] = uvExtent[i] > 0.f ? toUnorm16((vertex.uv[i] - header.uvMin[i]) / uvExtent[i]) : 0;
+			}
+			out[v] = quantized;
+		}
+	} else if (!mesh.vertices.empty()) {
+		std::memcpy(bytes.data() + header.vertexOffset, mesh.vertices.data(), mesh.vertices.size() * sizeof(MeshVertex));
+	}
+	if (!mesh.indices.empty()) {
+		std::memcpy(bytes.data() + header.indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof(std::uint32_t));
+	}
+
+	std::ofstream file;
+	file.exceptions(file.exceptions() | std::ofstream::failbit | std::ofstream::badbit);
+	file.open(path, std::ios::binary | std::ios::trunc);
+	file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+MeshCache::MeshCache(const std::string &path) : file(path) {
+	if (file.size() < sizeof(MeshCacheHeader)) {
+		throw std::runtime_error(path + " is not a mesh cache.");
+	}
+	this->header = reinterpret_cast<const MeshCacheHeader *>(file.data());
+	if (header->magic != MeshCacheHeader::MAGIC || header->version != MeshCacheHeader::VERSION) {
+		throw std::runtime_error(path + " is not a mesh cache of version " + std::to_string(MeshCacheHeader::VERSION) + '.');
+	}
+	const std::size_t expectedStride = isQuantized() ? sizeof(QuantizedVertex) : sizeof(MeshVertex);
+	const std::size_t vertexAlignment = isQuantized() ? alignof(QuantizedVertex) : alignof(MeshVertex);
+	// The arrays are used in place : they must be within the file and aligned for their type.
+	if (header->vertexStride != expectedStride
+		|| header->vertexOffset % vertexAlignment != 0
+		|| !fitsIn(header->vertexOffset, header->vertexCount, header->vertexStride, file.size())
+		|| header->indexOffset % alignof(std::uint32_t) != 0
+		|| !fitsIn(header->indexOffset, header->indexCount, sizeof(std::uint32_t), file.size())) {
+		throw std::runtime_error(path + " is truncated or corrupted.");
+	}
+}
+
+bool matchesMeshCache(const MeshData &mesh, const MeshCache &cache) {
+	if (cache.indexCount() != mesh.indices.size() || cache.getHeader().vertexCount != mesh.vertices.size()
+		|| !std::equal(mesh.indices.cbegin(), mesh.indices.cend(), cache.indices())) {
+		return false;
+	}
+	if (!cache.isQuantized()) {
+		return mesh.vertices.empty() || std::memcmp(cache.vertexData(), mesh.vertices.data(), cache.vertexDataSize()) == 0;
+	}
+	const auto &header = cache.getHeader();
+	const auto *quantized = reinterpret_cast<const QuantizedVertex *>(cache.vertexData());
+	for (std::size_t v = 0; v < mesh.vertices.size(); ++v) {
+		for (std::size_t i = 0; i < 3; ++i) {
+			const float center = (header.positionMin[i] + header.positionMax[i]) * 0.5f;
+			const float halfExtent = (header.positionMax[i] - header.positionMin[i]) * 0.5f;
+			const float position = center + static_cast<float>(quantized[v].position[i]) / 32767.f * halfExtent;
+			if (std::abs(position - mesh.vertices[v].position[i]) > halfExtent / 32767.f + 1e-6f) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
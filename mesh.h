@@ -0,0 +1,128 @@
+#ifndef VULKANTUTORIAL_MESH_H
+#define VULKANTUTORIAL_MESH_H
+
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct MeshVertex {
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+/**
+ * \brief Compact vertex : position in snorm16 relative to the bounds of the mesh, normal in snorm8, uv in unorm16 relative to the uv bounds.
+ */
+struct QuantizedVertex {
+	std::int16_t position[4]; ///< w is padding, so that the attribute stays 8 bytes aligned.
+	std::int8_t normal[4];
+	std::uint16_t uv[2];
+};
+
+struct MeshData {
+	std::vector<MeshVertex> vertices;
+	std::vector<std::uint32_t> indices; ///< Triangle list.
+};
+
+/**
+ * \brief Load a Wavefront OBJ file : memory mapped, parsed in parallel with OpenMP, polygons triangulated and identical
+ * position/uv/normal triplets merged into a single vertex.
+ * \throw std::runtime_error on I/O error or malformed indices.
+ */
+MeshData loadObj(const std::string &path);
+
+/**
+ * \brief Reorder the triangles for the post-transform vertex cache (Forsyth's linear-speed algorithm).
+ * \param cacheSize size of the simulated LRU cache.
+ */
+void optimizeVertexCache(std::vector<std::uint32_t> &indices, std::size_t vertexCount, std::size_t cacheSize = 32);
+
+/**
+ * \brief Reorder the vertices in the order in which the indices first use them, for vertex fetch locality.
+ * Must run after optimizeVertexCache, which works on the triangle order.
+ */
+void optimizeVertexFetch(MeshData &mesh);
+
+/**
+ * \brief Full ingestion : load, then the cache and fetch optimizations.
+ */
+MeshData importMesh(const std::string &path);
+
+struct MeshCacheHeader {
+	static constexpr std::uint32_t MAGIC = 0x434D5456; // "VTMC"
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr std::uint32_t QUANTIZED = 1u << 0;
+
+	std::uint32_t magic{ MAGIC };
+	std::uint32_t version{ VERSION };
+	std::uint32_t flags{ 0 };
+	std::uint32_t vertexStride{ 0 };
+	std::uint64_t vertexCount{ 0 };
+	std::uint64_t indexCount{ 0 };
+	std::uint64_t vertexOffset{ 0 }; ///< From the start of the file.
+	std::uint64_t indexOffset{ 0 };  ///< From the start of the file.
+	float positionMin[3]{};
+	float positionMax[3]{};
+	float uvMin[2]{};
+	float uvMax[2]{};
+};
+
+/**
+ * \brief Write mesh in the binary cache format read back by MeshCache.
+ * \param quantize store QuantizedVertex instead of MeshVertex.
+ */
+void writeMeshCache(const std::string &path, const MeshData &mesh, bool quantize);
+
+/**
+ * @class MeshCache
+ * \brief Binary mesh written by writeMeshCache(), loaded with a single mmap : the vertices and indices are used in place.
+ */
+class MeshCache {
+private:
+	MappedFile file;
+	const MeshCacheHeader *header{ nullptr };
+
+public:
+	MeshCache() = default;
+
+	/**
+	 * \throw std::runtime_error if the file is not a valid cache of this version.
+	 */
+	explicit MeshCache(const std::string &path);
+
+	[[nodiscard]] const MeshCacheHeader &getHeader() const noexcept {
+		return *header;
+	}
+
+	[[nodiscard]] bool isQuantized() const noexcept {
+		return header->flags & MeshCacheHeader::QUANTIZED;
+	}
+
+	/// Points to MeshVertex or QuantizedVertex depending on isQuantized().
+	[[nodiscard]] const std::byte *vertexData() const noexcept {
+		return file.data() + header->vertexOffset;
+	}
+
+	[[nodiscard]] std::size_t vertexDataSize() const noexcept {
+		return header->vertexCount * header->vertexStride;
+	}
+
+	[[nodiscard]] const std::uint32_t *indices() const noexcept {
+		return reinterpret_cast<const std::uint32_t *>(file.data() + header->indexOffset);
+	}
+
+	[[nodiscard]] std::size_t indexCount() const noexcept {
+		return header->indexCount;
+	}
+};
+
+/**
+ * \brief Whether cache holds mesh : the same indices, and the same vertices up to the quantization step if quantized.
+ */
+bool matchesMeshCache(const MeshData &mesh, const MeshCache &cache);
+
+#endif //VULKANTUTORIAL_MESH_H
@@ -0,0 +1,47 @@
+#include "mesh.h"
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+/**
+ * \brief Offline conversion of a Wavefront OBJ file into the binary mesh cache read by MeshCache :
+ * ./VulkanTutorialMeshImport mesh.obj mesh.cache [--quantize]
+ *
+ * The cache is mapped back and checked against the imported mesh before reporting success.
+ */
+int main(int argc, char **argv) {
+	std::string objPath;
+	std::string cachePath;
+	bool quantize = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--quantize") == 0) {
+			quantize = true;
+		} else if (objPath.empty()) {
+			objPath = argv[i];
+		} else if (cachePath.empty()) {
+			cachePath = argv[i];
+		} else {
+			objPath.clear();
+			break;
+		}
+	}
+	if (objPath.empty() || cachePath.empty()) {
+		std::cerr << "usage: " << argv[0] << " mesh.obj mesh.cache [--quantize]\n";
+		return EXIT_FAILURE;
+	}
+
+	try {
+		const auto mesh = importMesh(objPath);
+		writeMeshCache(cachePath, mesh, quantize);
+		if (!matchesMeshCache(mesh, MeshCache(cachePath))) {
+			std::cerr << cachePath << " does not read back as the imported mesh.\n";
+			return EXIT_FAILURE;
+		}
+		std::cerr << objPath << " : " << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles written to " << cachePath << '\n';
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#ifndef VULKANTUTORIAL_RENDER_DATA_H
+#define VULKANTUTORIAL_RENDER_DATA_H
+
+#include "frustum_culling.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * \brief Per object data, read through a dynamic uniform buffer. Layout matches std140 in shaders/shader.vert.
+ */
+struct ObjectUniforms {
+	float transform[16]; ///< Column major.
+	float color[4];
+};
+
+/**
+ * \brief Per draw data small enough to go through push constants.
+ */
+struct DrawPushConstants {
+	float time;
+	std::uint32_t objectIndex;
+};
+
+/**
+ * \brief Rotation, scale and translation of an object, with x corrected by the aspect ratio (height / width) of the target.
+ */
+[[gnu::always_inline]] inline ObjectUniforms makeObjectUniforms(const ObjectState &object, const float aspect) {
+	const float c = std::cos(object.rotation) * object.scale;
+	const float s = std::sin(object.rotation) * object.scale;
+	return ObjectUniforms{
+			{ c * aspect, s, 0.f, 0.f,
+			  -s * aspect, c, 0.f, 0.f,
+			  0.f, 0.f, 1.f, 0.f,
+			  object.position[0], object.position[1], 0.f, 1.f },
+			{ 1.f, 1.f, 1.f, 1.f }};
+}
+
+/// Radius of the circle around the triangle of shaders/shader.vert, whose farthest vertices are at (±0.5, 0.5).
+constexpr float OBJECT_BOUNDING_RADIUS = 0.70710678f;
+
+/**
+ * \brief Bounding sphere, in clip space, of the object as transformed by makeObjectUniforms(object, aspect).
+ */
+[[gnu::always_inline]] inline void writeObjectBounds(BoundingSpheres &bounds, const std::size_t index, const ObjectState &object, const float aspect) noexcept {
+	bounds.set(index, object.position[0], object.position[1], 0.f, OBJECT_BOUNDING_RADIUS * object.scale * std::max(aspect, 1.f));
+}
+
+/**
+ * \brief The objects are placed straight in clip space, so their frustum is the clip volume itself.
+ */
+inline Frustum sceneFrustum() noexcept {
+	constexpr float identity[16] = { 1.f, 0.f, 0.f, 0.f,
+									 0.f, 1.f, 0.f, 0.f,
+									 0.f, 0.f, 1.f, 0.f,
+									 0.f, 0.f, 0.f, 1.f };
+	return Frustum::fromMatrix(identity);
+}
+
+#endif //VULKANTUTORIAL_RENDER_DATA_H
@@ -0,0 +1,202 @@
+#include "scene_renderer.h"
+#include <array>
+#include <fstream>
+
+std::vector<char> readFile(const std::string &filename) {
+	std::ifstream file;
+	file.exceptions(file.exceptions() | std::ifstream::failbit | std::ifstream::badbit);
+	file.open(filename, std::ios::ate | std::ios::binary);
+	std::size_t fileSize = file.tellg();
+	std::vector<char> buffer(fileSize);
+
+	file.seekg(0);
+	file.read(buffer.data(), fileSize);
+	return buffer;
+}
+
+vk::UniqueShaderModule createShaderModule(const vk::Device &device, const std::vector<char> &code) {
+	return device.createShaderModuleUnique(vk::ShaderModuleCreateInfo{
+			{},
+			code.size(),
+			reinterpret_cast<const std::uint32_t *>(code.data())
+	});
+}
+
+vk::UniqueDescriptorSetLayout createObjectDescriptorSetLayout(const vk::Device &device) {
+	constexpr vk::DescriptorSetLayoutBinding objectBinding{ 0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex };
+	const vk::DescriptorSetLayoutCreateInfo layoutInfo{{}, 1, &objectBinding };
+	return device.createDescriptorSetLayoutUnique(layoutInfo);
+}
+
+vk::UniquePipelineLayout createObjectPipelineLayout(const vk::Device &device, const vk::DescriptorSetLayout &descriptorSetLayout) {
+	constexpr vk::PushConstantRange pushConstantRange{ vk::ShaderStageFlagBits::eVertex, 0, sizeof(DrawPushConstants) };
+	const vk::PipelineLayoutCreateInfo pipelineLayoutInfo{{}, 1, &descriptorSetLayout, 1, &pushConstantRange };
+	return device.createPipelineLayoutUnique(pipelineLayoutInfo);
+}
+
+vk::UniqueRenderPass createColorRenderPass(const vk::Device &device, const vk::Format format, const vk::ImageLayout finalLayout) {
+	const vk::AttachmentDescription colorAttachment{{},
+													format,
+													vk::SampleCountFlagBits::e1,
+													vk::AttachmentLoadOp::eClear,
+													vk::AttachmentStoreOp::eStore,
+													vk::AttachmentLoadOp::eDontCare,
+													vk::AttachmentStoreOp::eDontCare,
+													vk::ImageLayout::eUndefined,
+													finalLayout };
+	constexpr vk::AttachmentReference colorAttachmentRef{ 0, vk::ImageLayout::eColorAttachmentOptimal };
+	const vk::SubpassDescription subpass{{}, vk::PipelineBindPoint::eGraphics, {}, {}, 1, &colorAttachmentRef };
+	constexpr vk::SubpassDependency dependency{
+			VK_SUBPASS_EXTERNAL,
+			0,
+			{ vk::PipelineStageFlagBits::eColorAttachmentOutput },
+			{ vk::PipelineStageFlagBits::eColorAttachmentOutput },
+			{ vk::AccessFlagBits::eMemoryRead },
+			{ vk::AccessFlagBits::eColorAttachmentWrite }
+	};
+	const vk::RenderPassCreateInfo renderPassInfo{{}, 1, &colorAttachment, 1, &subpass, 1, &dependency };
+	return device.createRenderPassUnique(renderPassInfo);
+}
+
+vk::UniquePipeline createObjectPipeline(const vk::Device &device, const vk::PipelineLayout &pipelineLayout, const vk::RenderPass &renderPass,
+										const vk::ShaderModule &vertShaderModule, const vk::ShaderModule &fragShaderModule,
+										const vk::PipelineCache &cache) {
+	const vk::PipelineShaderStageCreateInfo shaderStages[] = {
+			vk::PipelineShaderStageCreateInfo{
+					{},
+					vk::ShaderStageFlagBits::eVertex,
+					vertShaderModule,
+					"main" },
+			vk::PipelineShaderStageCreateInfo{
+					{},
+					vk::ShaderStageFlagBits::eFragment,
+					fragShaderModule,
+					"main" }
+	};
+	const vk::PipelineVertexInputStateCreateInfo vertexInputInfo{{}, 0, nullptr, 0, nullptr };
+	const vk::PipelineInputAssemblyStateCreateInfo inputAssembly{{}, vk::PrimitiveTopology::eTriangleList, false };
+	const vk::PipelineViewportStateCreateInfo viewportState{{}, 1, nullptr, 1, nullptr };
+	const vk::PipelineRasterizationStateCreateInfo rasterizer{{},
+															  false,
+															  false,
+															  vk::PolygonMode::eFill,
+															  vk::CullModeFlagBits::eBack,
+															  vk::FrontFace::eClockwise,
+															  false,
+															  0.0f,
+															  0.0f,
+															  0.0f,
+															  1.0f };
+	const vk::PipelineMultisampleStateCreateInfo multisampling{{},
+															   vk::SampleCountFlagBits::e1,
+															   false,
+															   1.0f,
+															   nullptr,
+															   false,
+															   false };
+	const vk::PipelineColorBlendAttachmentState colorBlendAttachment{
+			false,
+			vk::BlendFactor::eOne,
+			vk::BlendFactor::eZero,
+			vk::BlendOp::eAdd,
+			vk::BlendFactor::eOne,
+			vk::BlendFactor::eZero,
+			vk::BlendOp::eAdd,
+			vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA };
+	const vk::PipelineColorBlendStateCreateInfo colorBlending{{}, false, vk::LogicOp::eCopy, 1, &colorBlendAttachment, { 0.0f, 0.0f, 0.0f, 0.0f }};
+	const vk::DynamicState dynamicStates[] = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+	const vk::PipelineDynamicStateCreateInfo dynamicState{{}, 2, dynamicStates };
+	const vk::GraphicsPipelineCreateInfo pipelineInfo{
+			{}, 2, shaderStages, &vertexInputInfo, &inputAssembly, nullptr, &viewportState, &rasterizer, &multisampling,
+			nullptr, &colorBlending,
+			&dynamicState, pipelineLayout, renderPass, 0 };
+	return device.createGraphicsPipelineUnique(cache, pipelineInfo).value;
+}
+
+ObjectDescriptors createObjectDescriptors(const vk::Device &device, const vk::DescriptorSetLayout &descriptorSetLayout, const vk::Buffer &buffer) {
+	ObjectDescriptors descriptors;
+	constexpr vk::DescriptorPoolSize poolSize{ vk::DescriptorType::eUniformBufferDynamic, 1 };
+	const vk::DescriptorPoolCreateInfo poolInfo{{}, 1, 1, &poolSize };
+	descriptors.pool = device.createDescriptorPoolUnique(poolInfo);
+
+	const vk::DescriptorSetAllocateInfo allocInfo{ *descriptors.pool, 1, &descriptorSetLayout };
+	descriptors.set = device.allocateDescriptorSets(allocInfo).front();
+
+	// The range is one object : the dynamic offset given at bind time selects which one.
+	const vk::DescriptorBufferInfo bufferInfo{ buffer, 0, sizeof(ObjectUniforms) };
+	const vk::WriteDescriptorSet descriptorWrite{ descriptors.set, 0, 0, 1, vk::DescriptorType::eUniformBufferDynamic, nullptr, &bufferInfo };
+	device.updateDescriptorSets(descriptorWrite, {});
+	return descriptors;
+}
+
+void SceneRecorder::reserve(const std::size_t objects, const std::size_t draws) {
+	objectBounds.resize(objects);
+	visibleObjects.reserve(objects);
+	drawQueue.reserve(draws);
+}
+
+bool SceneRecorder::queue(const std::uint64_t key, const std::uint32_t objectIndex, const ObjectState &object, const float aspect, UniformRing &ring) {
+	// Written straight into the mapped buffer : no staging, no map/unmap.
+	const auto allocation = ring.push(makeObjectUniforms(object, aspect));
+	if (!allocation.data) {
+		return false;
+	}
+	drawQueue.push(DrawPacket{ key, allocation.offset, objectIndex });
+	return true;
+}
+
+bool SceneRecorder::queuePass(const std::uint32_t pass, const std::uint32_t pipeline, const SceneState &state, const vk::Extent2D extent, UniformRing &ring) {
+	const float aspect = static_cast<float>(extent.height) / static_cast<float>(extent.width);
+	// The bounds depend on the aspect ratio, hence on the pass. Resizing within the reserved size does not allocate.
+	objectBounds.resize(state.objects.size());
+	for (std::size_t i = 0; i < state.objects.size(); ++i) {
+		writeObjectBounds(objectBounds, i, state.objects[i], aspect);
+	}
+	culler.cull(objectBounds, frustum, visibleObjects);
+	// One descriptor set so far, and the scene is flat.
+	const auto key = DrawKey::make(pass, pipeline, 0, 0.f);
+	for (const auto i : visibleObjects) {
+		if (!queue(key, i, state.objects[i], aspect, ring)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void SceneRecorder::begin(const vk::CommandBuffer &commandBuffer, const vk::PipelineLayout &pipelineLayout, const vk::DescriptorSet &descriptorSet,
+						  const float time) noexcept {
+	drawRecorder.begin(commandBuffer, pipelineLayout);
+	this->pipelineLayout = pipelineLayout;
+	this->descriptorSet = descriptorSet;
+	this->time = time;
+	this->nextPacket = 0;
+}
+
+void SceneRecorder::recordPass(const vk::CommandBuffer &commandBuffer, const vk::RenderPass &renderPass, const vk::Framebuffer &framebuffer,
+							   const vk::Extent2D extent, const std::uint32_t pass, const vk::Pipeline *pipelines) {
+	{
+		const vk::ClearValue clearColor{ std::array{ 0.f, 0.f, 0.f, 1.f }};
+		const vk::RenderPassBeginInfo renderPassInfo{ renderPass, framebuffer, {{ 0, 0 }, extent }, 1, &clearColor };
+		commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+	}
+	const vk::Viewport viewport{ 0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f };
+	const vk::Rect2D scissor{{ 0, 0 }, extent };
+	commandBuffer.setViewport(0, 1, &viewport);
+	commandBuffer.setScissor(0, 1, &scissor);
+	drawRecorder.invalidate();
+
+	const auto &packets = drawQueue.get();
+	// Sorted by key, the draws of this pass are contiguous. Those of passes that were not recorded are dropped.
+	while (nextPacket < packets.size() && DrawKey::pass(packets[nextPacket].key) < pass) {
+		++nextPacket;
+	}
+	for (; nextPacket < packets.size() && DrawKey::pass(packets[nextPacket].key) == pass; ++nextPacket) {
+		const auto &packet = packets[nextPacket];
+		drawRecorder.bindPipeline(pipelines[DrawKey::pipeline(packet.key)]);
+		drawRecorder.bindDescriptorSet(descriptorSet, packet.uniformOffset);
+		const DrawPushConstants constants{ time, packet.objectIndex };
+		commandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(constants), &constants);
+		drawRecorder.draw(3);
+	}
+	commandBuffer.endRenderPass();
+}
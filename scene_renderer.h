@@ -0,0 +1,137 @@
+#ifndef VULKANTUTORIAL_SCENE_RENDERER_H
+#define VULKANTUTORIAL_SCENE_RENDERER_H
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include <vulkan/vulkan.hpp>
+
+#include "draw_queue.h"
+#include "frustum_culling.h"
+#include "render_data.h"
+#include "simulation.h"
+#include "uniform_ring.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Whole content of a file, e.g. a SPIR-V module.
+ * \throw std::ios_base::failure if filename cannot be read.
+ */
+std::vector<char> readFile(const std::string &filename);
+
+vk::UniqueShaderModule createShaderModule(const vk::Device &device, const std::vector<char> &code);
+
+/**
+ * \brief Set 0 : the ObjectUniforms of a draw, through one dynamic uniform buffer.
+ */
+vk::UniqueDescriptorSetLayout createObjectDescriptorSetLayout(const vk::Device &device);
+
+/**
+ * \brief The object set layout and the DrawPushConstants.
+ */
+vk::UniquePipelineLayout createObjectPipelineLayout(const vk::Device &device, const vk::DescriptorSetLayout &descriptorSetLayout);
+
+/**
+ * \brief Single color attachment, cleared on load and left in finalLayout.
+ */
+vk::UniqueRenderPass createColorRenderPass(const vk::Device &device, vk::Format format, vk::ImageLayout finalLayout);
+
+/**
+ * \brief Pipeline drawing the objects. Viewport and scissor are dynamic : resizing the target does not invalidate it.
+ * \param cache optional, the pipeline is created from scratch without it.
+ */
+vk::UniquePipeline createObjectPipeline(const vk::Device &device, const vk::PipelineLayout &pipelineLayout, const vk::RenderPass &renderPass,
+										const vk::ShaderModule &vertShaderModule, const vk::ShaderModule &fragShaderModule,
+										const vk::PipelineCache &cache = {});
+
+/**
+ * \brief Pool and set pointing at one ObjectUniforms of buffer, the dynamic offset given at bind time selects which one.
+ */
+struct ObjectDescriptors {
+	vk::UniqueDescriptorPool pool;
+	vk::DescriptorSet set; // Freed with pool.
+};
+
+ObjectDescriptors createObjectDescriptors(const vk::Device &device, const vk::DescriptorSetLayout &descriptorSetLayout, const vk::Buffer &buffer);
+
+/**
+ * @class SceneRecorder
+ * \brief Frame recording shared by HelloTriangleApp and HeadlessRenderer : the objects of each pass are culled, their
+ * uniforms pushed into the ring and their draws queued, then the queue is sorted and recorded pass after pass.
+ *
+ * Once reserved for the largest frame, queuing, sorting and recording do not allocate.
+ */
+class SceneRecorder {
+private:
+	const Frustum frustum{ sceneFrustum() };
+	BoundingSpheres objectBounds;
+	FrustumCuller culler;
+	std::vector<std::uint32_t> visibleObjects;
+	DrawQueue drawQueue;
+	DrawRecorder drawRecorder;
+	vk::PipelineLayout pipelineLayout;
+	vk::DescriptorSet descriptorSet;
+	float time{ 0.f };
+	std::size_t nextPacket{ 0 }; ///< First packet of the next pass to record.
+
+public:
+	/**
+	 * \param objects largest scene, culled once per pass.
+	 * \param draws largest number of draws of a frame, all passes included.
+	 */
+	void reserve(std::size_t objects, std::size_t draws);
+
+	/**
+	 * \brief Start queuing the draws of a new frame.
+	 */
+	void clear() noexcept {
+		drawQueue.clear();
+	}
+
+	/**
+	 * \brief Push the uniforms of object into ring and queue its draw.
+	 * \return false if ring is full, the draw is then not queued.
+	 */
+	bool queue(std::uint64_t key, std::uint32_t objectIndex, const ObjectState &object, float aspect, UniformRing &ring);
+
+	/**
+	 * \brief Queue the objects of state visible in a target of that extent.
+	 * \param pipeline index of the pipeline drawing them in the table given to recordPass().
+	 * \return false if ring got full, the remaining objects are then not queued.
+	 */
+	bool queuePass(std::uint32_t pass, std::uint32_t pipeline, const SceneState &state, vk::Extent2D extent, UniformRing &ring);
+
+	void sort() {
+		drawQueue.sort();
+	}
+
+	[[nodiscard]] const std::vector<DrawPacket> &getDraws() const noexcept {
+		return drawQueue.get();
+	}
+
+	/**
+	 * \brief Start recording the queued draws into commandBuffer, which must have begun.
+	 * \param descriptorSet object set, as created by createObjectDescriptors().
+	 * \param time scene time, pushed with each draw.
+	 */
+	void begin(const vk::CommandBuffer &commandBuffer, const vk::PipelineLayout &pipelineLayout, const vk::DescriptorSet &descriptorSet, float time) noexcept;
+
+	/**
+	 * \brief Record the render pass of the next pass, in increasing pass order, with viewport and scissor covering extent.
+	 * \param pipelines indexed by the pipeline field of the keys, must cover every pipeline queued for pass.
+	 */
+	void recordPass(const vk::CommandBuffer &commandBuffer, const vk::RenderPass &renderPass, const vk::Framebuffer &framebuffer, vk::Extent2D extent,
+					std::uint32_t pass, const vk::Pipeline *pipelines);
+
+	/**
+	 * \brief Draws and state changes of the last recorded frame.
+	 */
+	[[nodiscard]] const DrawStatistics &getStatistics() const noexcept {
+		return drawRecorder.getStatistics();
+	}
+};
+
+#endif //VULKANTUTORIAL_SCENE_RENDERER_H
@@ -5,6 +5,16 @@ out gl_PerVertex {
     vec4 gl_Position;
 };
 
+layout(set = 0, binding = 0) uniform ObjectUniforms {
+    mat4 transform;
+    vec4 color;
+} object;
+
+layout(push_constant) uniform DrawPushConstants {
+    float time;
+    uint objectIndex;
+} draw;
+
 layout(location = 0) out vec3 fragColor;
 
 vec2 positions[3] = vec2[](
@@ -20,6 +30,7 @@ vec3(0.0, 0.0, 1.0)
 );
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
+    gl_Position = object.transform * vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    float pulse = 0.75 + 0.25 * sin(draw.time + float(draw.objectIndex));
+    fragColor = colors[gl_VertexIndex] * object.color.rgb * pulse;
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "simulation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	constexpr float twoPi = 6.283185307179586f;
+
+	/**
+	 * \brief Interpolation of an angle wrapped in [0, 2π[, taking the shortest path.
+	 */
+	[[gnu::always_inline]] inline float lerpAngle(const float a, const float b, const float t) {
+		float delta = b - a;
+		if (delta > twoPi * 0.5f) {
+			delta -= twoPi;
+		} else if (delta < -twoPi * 0.5f) {
+			delta += twoPi;
+		}
+		return a + delta * t;
+	}
+}
+
+SceneState Simulation::initialState(const std::size_t objectCount) {
+	// Objects are laid out on a grid covering the normalized device coordinates.
+	const auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(std::max<std::size_t>(objectCount, 1)))));
+	const float cell = 2.f / static_cast<float>(side);
+	SceneState initial;
+	initial.objects.resize(objectCount);
+	for (std::size_t i = 0; i < objectCount; ++i) {
+		auto &object = initial.objects[i];
+		object.position[0] = -1.f + cell * (static_cast<float>(i % side) + 0.5f);
+		object.position[1] = -1.f + cell * (static_cast<float>(i / side) + 0.5f);
+		object.scale = cell;
+	}
+	return initial;
+}
+
+// Every slot gets vectors of the right size now, so that publishing never allocates afterwards.
+Simulation::Simulation(const std::size_t objectCount, const std::chrono::nanoseconds timestep) :
+		timestep(timestep), state(initialState(objectCount)), snapshots(SceneSnapshot{ state, state, clock::now(), 0 }) {
+	angularVelocities.resize(objectCount);
+	for (std::size_t i = 0; i < objectCount; ++i) {
+		angularVelocities[i] = 0.5f + static_cast<float>(i % 7) * 0.25f;
+	}
+}
+
+Simulation::~Simulation() {
+	stop();
+}
+
+void Simulation::start() {
+	if (running.exchange(true)) {
+		return;
+	}
+	this->thread = std::thread(&Simulation::loop, this);
+}
+
+void Simulation::stop() {
+	running = false;
+	if (this->thread.joinable()) {
+		this->thread.join();
+	}
+}
+
+void Simulation::loop() {
+	const double dt = std::chrono::duration<double>(timestep).count();
+	auto nextTick = clock::now();
+	std::uint64_t tick = 0;
+	while (running.load(std::memory_order_relaxed)) {
+		auto &slot = snapshots.writeBuffer();
+		slot.previous = state; // Same sizes everywhere : plain copies, no allocation.
+		step(dt);
+		slot.current = state;
+		slot.tickTime = clock::now();
+		slot.tick = ++tick;
+		snapshots.publish();
+
+		nextTick += timestep;
+		const auto now = clock::now();
+		if (nextTick < now) {
+			// Too late (debugger, machine under load…) : do not try to catch up with a burst of ticks.
+			nextTick = now;
+		}
+		std::this_thread::sleep_until(nextTick);
+	}
+}
+
+void Simulation::step(const double dt) {
+	state.time += dt;
+	const auto fdt = static_cast<float>(dt);
+	for (std::size_t i = 0; i < state.objects.size(); ++i) {
+		auto &object = state.objects[i];
+		object.rotation = std::fmod(object.rotation + angularVelocities[i] * fdt, twoPi);
+	}
+}
+
+void Simulation::sample(SceneState &out) {
+	snapshots.consume();
+	const auto &snapshot = snapshots.readBuffer();
+	const double elapsed = std::chrono::duration<double>(clock::now() - snapshot.tickTime).count();
+	const auto alpha = static_cast<float>(std::clamp(elapsed / std::chrono::duration<double>(timestep).count(), 0., 1.));
+
+	out.time = snapshot.previous.time + (snapshot.current.time - snapshot.previous.time) * alpha;
+	const auto count = std::min(out.objects.size(), snapshot.current.objects.size());
+	for (std::size_t i = 0; i < count; ++i) {
+		const auto &a = snapshot.previous.objects[i];
+		const auto &b = snapshot.current.objects[i];
+		auto &o = out.objects[i];
+		o.position[0] = a.position[0] + (b.position[0] - a.position[0]) * alpha;
+		o.position[1] = a.position[1] + (b.position[1] - a.position[1]) * alpha;
+		o.rotation = lerpAngle(a.rotation, b.rotation, alpha);
+		o.scale = a.scale + (b.scale - a.scale) * alpha;
+	}
+}
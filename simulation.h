@@ -0,0 +1,83 @@
+#ifndef VULKANTUTORIAL_SIMULATION_H
+#define VULKANTUTORIAL_SIMULATION_H
+
+#include "triple_buffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+struct ObjectState {
+	float position[2]{ 0.f, 0.f };
+	float rotation{ 0.f };
+	float scale{ 1.f };
+};
+
+struct SceneState {
+	double time{ 0. };
+	std::vector<ObjectState> objects;
+};
+
+/**
+ * \brief What the simulation publishes at each tick : the two last states, so the renderer can interpolate between them.
+ */
+struct SceneSnapshot {
+	SceneState previous;
+	SceneState current;
+	std::chrono::steady_clock::time_point tickTime;
+	std::uint64_t tick{ 0 };
+};
+
+/**
+ * @class Simulation
+ * \brief Fixed timestep update thread. The states are handed to the renderer through a TripleBuffer so neither side blocks.
+ */
+class Simulation {
+public:
+	using clock = std::chrono::steady_clock;
+
+private:
+	std::chrono::nanoseconds timestep;
+	// Only touched by the simulation thread once started.
+	SceneState state;
+	std::vector<float> angularVelocities;
+
+	TripleBuffer<SceneSnapshot> snapshots;
+	std::thread thread;
+	std::atomic<bool> running{ false };
+
+	static SceneState initialState(std::size_t objectCount);
+
+	void loop();
+
+	void step(double dt);
+
+public:
+	static constexpr std::chrono::nanoseconds DEFAULT_TIMESTEP{ 1'000'000'000 / 60 };
+
+	explicit Simulation(std::size_t objectCount, std::chrono::nanoseconds timestep = DEFAULT_TIMESTEP);
+
+	Simulation(const Simulation &) = delete;
+
+	Simulation &operator=(const Simulation &) = delete;
+
+	~Simulation();
+
+	void start();
+
+	void stop();
+
+	/**
+	 * \brief Renderer side : interpolate between the last two published ticks at the current time. Never blocks.
+	 * \param out must have been sized with objectCount() objects, it is then only written in place.
+	 */
+	void sample(SceneState &out);
+
+	[[nodiscard]] std::size_t objectCount() const noexcept {
+		return state.objects.size();
+	}
+};
+
+#endif //VULKANTUTORIAL_SIMULATION_H
@@ -0,0 +1,78 @@
+#ifndef VULKANTUTORIAL_TRIPLE_BUFFER_H
+#define VULKANTUTORIAL_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * \brief Lock-free single producer / single consumer handoff of the latest value.
+ *
+ * The producer always owns one slot, the consumer another, and the third is exchanged atomically between them.
+ * Neither side ever waits : the producer can overwrite stale data and the consumer keeps reading its last slot
+ * until something newer is published.
+ * \tparam T type of the value exchanged. Each slot is default constructed once and reused afterwards.
+ */
+template<typename T>
+class TripleBuffer {
+private:
+	static constexpr std::uint8_t indexMask = 0b011;
+	static constexpr std::uint8_t freshBit = 0b100;
+
+	std::array<T, 3> buffers{};
+	/// Index of the shared slot, plus freshBit when it holds data the consumer has not seen yet.
+	std::atomic<std::uint8_t> shared{ 1 };
+	std::uint8_t writeIndex{ 0 };
+	std::uint8_t readIndex{ 2 };
+
+public:
+	TripleBuffer() = default;
+
+	/**
+	 * \brief Initialise the three slots with the same value, so that reused resources (vectors…) are already sized.
+	 * \param initial
+	 */
+	explicit TripleBuffer(const T &initial) : buffers{ initial, initial, initial } {}
+
+	TripleBuffer(const TripleBuffer &) = delete;
+
+	TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+	/**
+	 * \brief Producer side : slot to fill before calling publish().
+	 */
+	[[nodiscard]] T &writeBuffer() noexcept {
+		return buffers[writeIndex];
+	}
+
+	/**
+	 * \brief Producer side : hand the write slot over and take back the shared one.
+	 */
+	void publish() noexcept {
+		const auto previous = shared.exchange(static_cast<std::uint8_t>(writeIndex | freshBit), std::memory_order_acq_rel);
+		writeIndex = previous & indexMask;
+	}
+
+	/**
+	 * \brief Consumer side : grab the most recently published slot if there is one.
+	 * \return true if readBuffer() now refers to new data.
+	 */
+	bool consume() noexcept {
+		if (!(shared.load(std::memory_order_relaxed) & freshBit)) {
+			return false;
+		}
+		const auto previous = shared.exchange(readIndex, std::memory_order_acq_rel);
+		readIndex = previous & indexMask;
+		return true;
+	}
+
+	/**
+	 * \brief Consumer side : slot obtained by the last successful consume().
+	 */
+	[[nodiscard]] const T &readBuffer() const noexcept {
+		return buffers[readIndex];
+	}
+};
+
+#endif //VULKANTUTORIAL_TRIPLE_BUFFER_H
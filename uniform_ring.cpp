@@ -0,0 +1,32 @@
+#include "uniform_ring.h"
+
+UniformRing::UniformRing(const vk::PhysicalDevice &physicalDevice, const vk::Device &device, MemoryTracker &tracker, const vk::DeviceSize bytesPerFrame, const std::size_t frames) :
+		alignment(physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment) {
+	if (alignment == 0) {
+		alignment = 1;
+	}
+	partitionSize = alignedSize(bytesPerFrame, alignment);
+
+	const vk::BufferCreateInfo bufferInfo{{}, partitionSize * frames, vk::BufferUsageFlagBits::eUniformBuffer, vk::SharingMode::eExclusive };
+	this->buffer = device.createBufferUnique(bufferInfo);
+
+	const auto requirements = device.getBufferMemoryRequirements(*this->buffer);
+	this->memory = tracker.allocate(device,
+									requirements,
+									vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+									MemoryCategory::Buffer);
+	device.bindBufferMemory(*this->buffer, *this->memory, 0);
+
+	// Mapped once for the whole lifetime : coherent memory so no flush is needed either.
+	this->mapped = static_cast<std::byte *>(device.mapMemory(*this->memory, 0, VK_WHOLE_SIZE));
+}
+
+UniformRing::Allocation UniformRing::allocate(const vk::DeviceSize size) noexcept {
+	const auto aligned = alignedSize(size, alignment);
+	if (head + aligned > partitionSize) {
+		return {};
+	}
+	const auto offset = partitionBegin + head;
+	head += aligned;
+	return { static_cast<std::uint32_t>(offset), mapped + offset };
+}
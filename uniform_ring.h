@@ -0,0 +1,86 @@
+#ifndef VULKANTUTORIAL_UNIFORM_RING_H
+#define VULKANTUTORIAL_UNIFORM_RING_H
+
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include <vulkan/vulkan.hpp>
+
+#include "memory_tracker.h"
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @class UniformRing
+ * \brief Linear allocator over one persistently mapped, host visible and coherent uniform buffer.
+ *
+ * The buffer is split in as many partitions as frames in flight. Each frame allocates from its own partition, which is
+ * rewound by beginFrame() once the fence of that frame has been waited on. The data is then bound with dynamic offsets.
+ * Nothing is allocated nor mapped after construction.
+ */
+class UniformRing {
+public:
+	struct Allocation {
+		/// Offset from the start of the buffer, to be used as a dynamic offset.
+		std::uint32_t offset{ 0 };
+		/// Where to write the data, nullptr if the partition of the current frame is full.
+		void *data{ nullptr };
+	};
+
+private:
+	vk::UniqueBuffer buffer;
+	TrackedMemory memory;
+	std::byte *mapped{ nullptr }; // Unmapped implicitly when memory is freed.
+	vk::DeviceSize alignment{ 1 };
+	vk::DeviceSize partitionSize{ 0 };
+	vk::DeviceSize partitionBegin{ 0 };
+	vk::DeviceSize head{ 0 };
+
+public:
+	UniformRing() = default;
+
+	/**
+	 * \param physicalDevice to read minUniformBufferOffsetAlignment from.
+	 * \param device
+	 * \param tracker records the memory of the buffer, must outlive the ring.
+	 * \param bytesPerFrame capacity of each partition, before alignment.
+	 * \param frames number of partitions, one per frame in flight.
+	 */
+	UniformRing(const vk::PhysicalDevice &physicalDevice, const vk::Device &device, MemoryTracker &tracker, vk::DeviceSize bytesPerFrame, std::size_t frames);
+
+	/**
+	 * \brief Rewind the partition of this frame. Its fence must have been signaled.
+	 */
+	[[gnu::always_inline]] inline void beginFrame(const std::size_t frame) noexcept {
+		partitionBegin = partitionSize * frame;
+		head = 0;
+	}
+
+	[[nodiscard]] Allocation allocate(vk::DeviceSize size) noexcept;
+
+	template<typename T>
+	Allocation push(const T &value) noexcept {
+		const auto allocation = allocate(sizeof(T));
+		if (allocation.data) {
+			std::memcpy(allocation.data, &value, sizeof(T));
+		}
+		return allocation;
+	}
+
+	/**
+	 * \brief Size of one allocation of size bytes once aligned, useful to size the partitions.
+	 */
+	[[nodiscard]] static vk::DeviceSize alignedSize(vk::DeviceSize size, vk::DeviceSize alignment) noexcept {
+		return (size + alignment - 1) & ~(alignment - 1);
+	}
+
+	[[nodiscard]] vk::DeviceSize getAlignment() const noexcept {
+		return alignment;
+	}
+
+	[[nodiscard]] vk::Buffer get() const noexcept {
+		return *buffer;
+	}
+};
+
+#endif //VULKANTUTORIAL_UNIFORM_RING_H